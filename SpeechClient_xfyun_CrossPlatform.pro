@@ -4,13 +4,29 @@ TARGET = SpeechClient_xfyun
 TEMPLATE = app
 
 SOURCES += \
+    capturescheduler.cpp \
+    hotworddictionary.cpp \
+    hotwordfilter.cpp \
+    hotwordstream.cpp \
     main.cpp \
     mainwindow.cpp \
-    speechclient.cpp
+    meetingtranscriber.cpp \
+    recognitionresult.cpp \
+    speechclient.cpp \
+    subtitlewriter.cpp \
+    tlssessioncache.cpp
 
 HEADERS += \
+    capturescheduler.h \
+    hotworddictionary.h \
+    hotwordfilter.h \
+    hotwordstream.h \
     mainwindow.h \
-    speechclient.h
+    meetingtranscriber.h \
+    recognitionresult.h \
+    speechclient.h \
+    subtitlewriter.h \
+    tlssessioncache.h
 
 CONFIG += lrelease
 
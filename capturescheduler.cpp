@@ -0,0 +1,194 @@
+#include "capturescheduler.h"
+#include <QDebug>
+#include <cmath>
+
+CaptureScheduler::CaptureScheduler(QObject *parent)
+    : QObject(parent)
+    , m_context(new QObject)
+    , m_tickTimer(nullptr)
+    , m_frameIndex(0)
+{
+    m_thread.setObjectName("CaptureScheduler");
+    m_context->moveToThread(&m_thread);
+    m_thread.start(QThread::TimeCriticalPriority);
+}
+
+CaptureScheduler::~CaptureScheduler()
+{
+    stop();
+    m_thread.quit();
+    m_thread.wait();
+    delete m_context;
+}
+
+void CaptureScheduler::setDevices(const QList<QAudioDevice>& devices)
+{
+    m_devices = devices;
+}
+
+void CaptureScheduler::start()
+{
+    const QList<QAudioDevice> devices = m_devices;
+    QMetaObject::invokeMethod(m_context, [this, devices]() {
+        openChannels(devices);
+    }, Qt::BlockingQueuedConnection);
+}
+
+void CaptureScheduler::stop()
+{
+    QMetaObject::invokeMethod(m_context, [this]() {
+        closeChannels();
+    }, Qt::BlockingQueuedConnection);
+}
+
+void CaptureScheduler::openChannels(const QList<QAudioDevice>& devices)
+{
+    closeChannels();
+
+    QAudioFormat format;
+    format.setSampleRate(16000);
+    format.setChannelCount(1);
+    format.setSampleFormat(QAudioFormat::Int16);
+
+    m_channels.resize(devices.size());
+    m_rms.resize(devices.size());
+    m_frameIndex = 0;
+
+    for (int i = 0; i < devices.size(); ++i) {
+        const QAudioDevice& device = devices.at(i);
+        Channel& channel = m_channels[i];
+        channel.pending.reserve(FRAME_BYTES * (MAX_LAG_FRAMES + 2));
+        channel.preroll.reserve(PREROLL_FRAMES + 1);
+
+        if (device.isNull()) {
+            qDebug() << "Channel" << i << "has no audio device";
+            emit captureError("找不到合适的音频输入设备");
+            continue;
+        }
+        // 与单通道路径一致：不少后端报告不支持但实际可以采集，只记录不拒绝
+        if (!device.isFormatSupported(format))
+            qDebug() << "Channel" << i << "reports format not supported:" << device.description();
+
+        channel.source = new QAudioSource(device, format, m_context);
+        channel.source->setBufferSize(FRAME_BYTES * 4);
+        channel.io = channel.source->start();
+        qDebug() << "Channel" << i << "capturing from" << device.description();
+    }
+
+    m_tickTimer = new QTimer(m_context);
+    m_tickTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_tickTimer, &QTimer::timeout, m_context, [this]() { onTick(); });
+    m_tickTimer->start(FRAME_MS);
+}
+
+void CaptureScheduler::closeChannels()
+{
+    if (m_tickTimer) {
+        m_tickTimer->stop();
+        delete m_tickTimer;
+        m_tickTimer = nullptr;
+    }
+
+    for (int i = 0; i < m_channels.size(); ++i) {
+        Channel& channel = m_channels[i];
+        if (channel.source) {
+            channel.source->stop();
+            delete channel.source;
+        }
+        if (channel.active)
+            emit channelActiveChanged(i, false);
+    }
+    m_channels.clear();
+    m_rms.clear();
+}
+
+void CaptureScheduler::onTick()
+{
+    if (m_channels.isEmpty())
+        return;
+
+    for (Channel& channel : m_channels) {
+        if (!channel.io)
+            continue;
+        const qint64 available = channel.io->bytesAvailable();
+        if (available <= 0)
+            continue;
+        const qsizetype offset = channel.pending.size();
+        channel.pending.resize(offset + available);
+        const qint64 read = channel.io->read(channel.pending.data() + offset, available);
+        channel.pending.resize(offset + qMax<qint64>(read, 0));
+    }
+
+    for (;;) {
+        qsizetype minAvailable = -1;
+        qsizetype maxAvailable = 0;
+        for (const Channel& channel : m_channels) {
+            if (!channel.io)
+                continue;
+            minAvailable = minAvailable < 0 ? channel.pending.size() : qMin(minAvailable, channel.pending.size());
+            maxAvailable = qMax(maxAvailable, channel.pending.size());
+        }
+
+        if (minAvailable < 0)
+            break;
+        // 落后的设备在 processFrame() 中用静音补齐，保持各通道时间戳对齐
+        if (minAvailable < FRAME_BYTES && maxAvailable < FRAME_BYTES * MAX_LAG_FRAMES)
+            break;
+
+        processFrame();
+    }
+}
+
+void CaptureScheduler::processFrame()
+{
+    const qint64 timestamp = m_frameIndex * FRAME_MS;
+    const int sampleCount = FRAME_BYTES / sizeof(qint16);
+
+    float loudest = 0.0f;
+    for (int i = 0; i < m_channels.size(); ++i) {
+        QByteArray& pending = m_channels[i].pending;
+        if (pending.size() < FRAME_BYTES)
+            pending.append(FRAME_BYTES - pending.size(), '\0');
+
+        const qint16* samples = reinterpret_cast<const qint16*>(pending.constData());
+        double energy = 0.0;
+        for (int s = 0; s < sampleCount; ++s)
+            energy += double(samples[s]) * samples[s];
+        m_rms[i] = float(std::sqrt(energy / sampleCount));
+        loudest = qMax(loudest, m_rms[i]);
+    }
+
+    for (int i = 0; i < m_channels.size(); ++i) {
+        Channel& channel = m_channels[i];
+
+        const bool speech = m_rms[i] >= SPEECH_RMS && m_rms[i] * BLEED_RATIO >= loudest;
+        if (speech)
+            channel.hangover = HANGOVER_FRAMES;
+        else if (channel.hangover > 0)
+            --channel.hangover;
+
+        const bool active = channel.hangover > 0;
+        if (active != channel.active) {
+            channel.active = active;
+            emit channelActiveChanged(i, active);
+        }
+
+        const QByteArray frame = channel.pending.left(FRAME_BYTES);
+        if (active) {
+            // 激活前的几帧一起送出，避免切掉字头
+            const qint64 prerollStart = timestamp - channel.preroll.size() * FRAME_MS;
+            for (int p = 0; p < channel.preroll.size(); ++p)
+                emit frameReady(i, prerollStart + p * FRAME_MS, channel.preroll.at(p));
+            channel.preroll.clear();
+            emit frameReady(i, timestamp, frame);
+        } else {
+            channel.preroll.append(frame);
+            if (channel.preroll.size() > PREROLL_FRAMES)
+                channel.preroll.removeFirst();
+        }
+
+        channel.pending.remove(0, FRAME_BYTES);
+    }
+
+    ++m_frameIndex;
+}
@@ -0,0 +1,76 @@
+#ifndef CAPTURESCHEDULER_H
+#define CAPTURESCHEDULER_H
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QAudioSource>
+#include <QAudioDevice>
+#include <QAudioFormat>
+#include <QByteArray>
+#include <QList>
+
+// 在一个共享的采集线程里同时读取多个麦克风，按统一的帧时钟切成对齐的
+// 40ms 帧，并通过跨通道能量比较丢弃串音通道，只输出活跃通道的音频。
+class CaptureScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CaptureScheduler(QObject *parent = nullptr);
+    ~CaptureScheduler();
+
+    void setDevices(const QList<QAudioDevice>& devices);
+    int channelCount() const { return m_devices.size(); }
+
+    void start();
+    void stop();
+
+    // 每帧时长与字节数：16kHz、单声道、16bit，与讯飞建议的每 40ms 1280 字节一致
+    static constexpr int FRAME_MS = 40;
+    static constexpr int FRAME_BYTES = 16000 / 1000 * FRAME_MS * 2;
+
+signals:
+    // timestamp 为自采集开始以来的毫秒数，所有通道共用同一帧时钟
+    void frameReady(int channel, qint64 timestamp, const QByteArray& pcm);
+    void channelActiveChanged(int channel, bool active);
+    void captureError(const QString& error);
+
+private:
+    struct Channel {
+        QAudioSource* source = nullptr;
+        QIODevice* io = nullptr;
+        QByteArray pending;
+        QList<QByteArray> preroll;
+        int hangover = 0;
+        bool active = false;
+    };
+
+    // 以下函数只在采集线程中调用
+    void openChannels(const QList<QAudioDevice>& devices);
+    void closeChannels();
+    void onTick();
+    void processFrame();
+
+    QList<QAudioDevice> m_devices;
+
+    QThread m_thread;
+    QObject* m_context;
+    QTimer* m_tickTimer;
+    QList<Channel> m_channels;
+    QList<float> m_rms;
+    qint64 m_frameIndex;
+
+    // 判定为语音的最小 RMS，相当于原单通道逻辑中的幅度阈值
+    static constexpr float SPEECH_RMS = 300.0f;
+    // 比最响通道低 10dB 以上视为串音
+    static constexpr float BLEED_RATIO = 3.16f;
+    // 语音结束后保持活跃的帧数，避免切断字尾
+    static constexpr int HANGOVER_FRAMES = 10;
+    // 通道激活时补发的之前的帧数（320ms），避免切断字头
+    static constexpr int PREROLL_FRAMES = 8;
+    // 某个设备落后超过该帧数时用静音补齐，保证其余通道不被阻塞
+    static constexpr int MAX_LAG_FRAMES = 5;
+};
+
+#endif // CAPTURESCHEDULER_H
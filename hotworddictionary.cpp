@@ -0,0 +1,428 @@
+#include "hotworddictionary.h"
+#include <QHash>
+#include <QSaveFile>
+#include <QStringList>
+#include <QDebug>
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace {
+const char MAGIC[4] = { 'H', 'W', 'D', 'A' };
+const quint32 VERSION = 2;
+const int CHARMAP_SIZE = 65536;
+
+struct TrieNode {
+    std::map<quint16, int> children;
+    int entry = -1;
+};
+
+template <typename T>
+void appendArray(QByteArray& image, const T* data, size_t count)
+{
+    image.append(reinterpret_cast<const char*>(data), qsizetype(count * sizeof(T)));
+}
+}
+
+QByteArray HotwordDictionary::compile(const Entries& entries)
+{
+    QHash<QString, QString> replacements;
+    QStringList patterns;
+    for (const auto& entry : entries) {
+        if (entry.first.isEmpty())
+            continue;
+        if (!replacements.contains(entry.first))
+            patterns.append(entry.first);
+        replacements.insert(entry.first, entry.second);
+    }
+
+    // 只给词典中出现的字符编号，CJK 字符集再大双数组也保持紧凑
+    std::vector<quint16> charMap(CHARMAP_SIZE, 0);
+    quint16 alphabetSize = 0;
+    for (const QString& pattern : std::as_const(patterns)) {
+        for (QChar ch : pattern) {
+            if (charMap[ch.unicode()] == 0)
+                charMap[ch.unicode()] = ++alphabetSize;
+        }
+    }
+
+    std::vector<TrieNode> trie(1);
+    for (int e = 0; e < patterns.size(); ++e) {
+        int node = 0;
+        for (QChar ch : patterns.at(e)) {
+            const quint16 code = charMap[ch.unicode()];
+            auto it = trie[node].children.find(code);
+            if (it == trie[node].children.end()) {
+                trie.emplace_back();
+                const int child = int(trie.size()) - 1;
+                trie[node].children.emplace(code, child);
+                node = child;
+            } else {
+                node = it->second;
+            }
+        }
+        trie[node].entry = e;
+    }
+
+    // 按广度优先顺序放置状态，base 取第一个能容纳全部子节点的位置
+    std::vector<qint32> base(1, 0);
+    std::vector<qint32> check(1, -1);
+    std::vector<int> daIndex(trie.size(), -1);
+    std::vector<int> order;
+    order.reserve(trie.size());
+    order.push_back(0);
+    daIndex[0] = 0;
+
+    auto ensureSize = [&](size_t size) {
+        if (base.size() < size) {
+            base.resize(size, 0);
+            check.resize(size, -1);
+        }
+    };
+
+    size_t firstFree = 1;
+    for (size_t qi = 0; qi < order.size(); ++qi) {
+        const int node = order[qi];
+        const qint32 state = daIndex[node];
+        const auto& children = trie[node].children;
+        if (children.empty())
+            continue;
+
+        while (firstFree < check.size() && check[firstFree] != -1)
+            ++firstFree;
+
+        const quint16 firstCode = children.begin()->first;
+        size_t pos = qMax<size_t>(firstFree, size_t(firstCode) + 1);
+        qint32 b = 0;
+        for (;; ++pos) {
+            ensureSize(pos + 1);
+            if (check[pos] != -1)
+                continue;
+            b = qint32(pos - firstCode);
+            bool fits = true;
+            for (const auto& child : children) {
+                const size_t slot = size_t(b) + child.first;
+                ensureSize(slot + 1);
+                if (check[slot] != -1) {
+                    fits = false;
+                    break;
+                }
+            }
+            if (fits)
+                break;
+        }
+
+        base[state] = b;
+        for (const auto& child : children) {
+            const qint32 slot = b + child.first;
+            check[slot] = state;
+            daIndex[child.second] = slot;
+            order.push_back(child.second);
+        }
+    }
+
+    const size_t stateCount = base.size();
+    auto transition = [&](qint32 state, quint16 code) -> qint32 {
+        const size_t slot = size_t(base[state]) + code;
+        return slot < stateCount && check[slot] == state ? qint32(slot) : -1;
+    };
+
+    // 失败指针与输出：output 记录沿失败链可达的最长词条，匹配时直接取用
+    std::vector<qint32> fail(stateCount, 0);
+    std::vector<qint32> output(stateCount, -1);
+    std::vector<qint32> depth(stateCount, 0);
+    for (const int node : order) {
+        const qint32 state = daIndex[node];
+        const int own = trie[node].entry;
+        output[state] = own >= 0 ? own : (state == 0 ? -1 : output[fail[state]]);
+
+        for (const auto& child : trie[node].children) {
+            const qint32 target = daIndex[child.second];
+            depth[target] = depth[state] + 1;
+            if (state == 0) {
+                fail[target] = 0;
+                continue;
+            }
+            qint32 f = fail[state];
+            for (;;) {
+                const qint32 next = transition(f, child.first);
+                if (next >= 0) {
+                    fail[target] = next;
+                    break;
+                }
+                if (f == 0) {
+                    fail[target] = 0;
+                    break;
+                }
+                f = fail[f];
+            }
+        }
+    }
+
+    std::vector<Entry> entryTable;
+    entryTable.reserve(patterns.size());
+    QString pool;
+    for (const QString& pattern : std::as_const(patterns)) {
+        const QString replacement = replacements.value(pattern);
+        Entry entry;
+        entry.patternLength = quint32(pattern.size());
+        entry.replacementOffset = quint32(pool.size());
+        entry.replacementLength = quint32(replacement.size());
+        entryTable.push_back(entry);
+        pool.append(replacement);
+    }
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.stateCount = quint32(stateCount);
+    header.entryCount = quint32(entryTable.size());
+    header.poolLength = quint32(pool.size());
+    header.reserved = 0;
+
+    QByteArray image;
+    image.reserve(qsizetype(sizeof(Header) + CHARMAP_SIZE * sizeof(quint16)
+                            + stateCount * 5 * sizeof(qint32)
+                            + entryTable.size() * sizeof(Entry) + pool.size() * sizeof(char16_t)));
+    appendArray(image, &header, 1);
+    appendArray(image, charMap.data(), charMap.size());
+    appendArray(image, base.data(), stateCount);
+    appendArray(image, check.data(), stateCount);
+    appendArray(image, fail.data(), stateCount);
+    appendArray(image, output.data(), stateCount);
+    appendArray(image, depth.data(), stateCount);
+    appendArray(image, entryTable.data(), entryTable.size());
+    appendArray(image, pool.utf16(), size_t(pool.size()));
+
+    qDebug() << "Compiled hotword dictionary:" << entryTable.size() << "entries,"
+             << stateCount << "states," << image.size() << "bytes";
+    return image;
+}
+
+bool HotwordDictionary::compileTextFile(const QString& textPath, const QString& binaryPath, QString* error)
+{
+    QFile in(textPath);
+    if (!in.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (error)
+            *error = in.errorString();
+        return false;
+    }
+
+    Entries entries;
+    while (!in.atEnd()) {
+        const QString line = QString::fromUtf8(in.readLine()).trimmed();
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+
+        const qsizetype tab = line.indexOf('\t');
+        if (tab < 0) {
+            entries.append({ line, QString(line.size(), '*') });
+        } else {
+            entries.append({ line.left(tab), line.mid(tab + 1) });
+        }
+    }
+
+    // 原子替换，正在映射旧文件的进程不受影响
+    QSaveFile out(binaryPath);
+    if (!out.open(QIODevice::WriteOnly)) {
+        if (error)
+            *error = out.errorString();
+        return false;
+    }
+    out.write(compile(entries));
+    if (!out.commit()) {
+        if (error)
+            *error = out.errorString();
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<const HotwordDictionary> HotwordDictionary::fromImage(const QByteArray& image, QString* error)
+{
+    std::shared_ptr<HotwordDictionary> dictionary(new HotwordDictionary);
+    dictionary->m_image = image;
+    if (!dictionary->attach(reinterpret_cast<const uchar*>(dictionary->m_image.constData()),
+                            dictionary->m_image.size(), error))
+        return nullptr;
+    return dictionary;
+}
+
+std::shared_ptr<const HotwordDictionary> HotwordDictionary::load(const QString& binaryPath, QString* error)
+{
+    std::shared_ptr<HotwordDictionary> dictionary(new HotwordDictionary);
+    dictionary->m_file = std::make_unique<QFile>(binaryPath);
+    QFile* file = dictionary->m_file.get();
+    if (!file->open(QIODevice::ReadOnly)) {
+        if (error)
+            *error = file->errorString();
+        return nullptr;
+    }
+
+    const qint64 size = file->size();
+    const uchar* data = size > 0 ? file->map(0, size) : nullptr;
+    if (!data) {
+        if (error)
+            *error = QString("无法映射词典文件: %1").arg(binaryPath);
+        return nullptr;
+    }
+
+    if (!dictionary->attach(data, size, error))
+        return nullptr;
+    return dictionary;
+}
+
+bool HotwordDictionary::attach(const uchar* data, qint64 size, QString* error)
+{
+    auto fail = [error](const QString& message) {
+        if (error)
+            *error = message;
+        return false;
+    };
+
+    if (size < qint64(sizeof(Header)))
+        return fail("词典文件过短");
+
+    const Header* header = reinterpret_cast<const Header*>(data);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION)
+        return fail("词典文件格式不正确");
+
+    const qint64 stateCount = header->stateCount;
+    const qint64 expected = qint64(sizeof(Header)) + CHARMAP_SIZE * qint64(sizeof(quint16))
+                            + stateCount * 5 * qint64(sizeof(qint32))
+                            + qint64(header->entryCount) * qint64(sizeof(Entry))
+                            + qint64(header->poolLength) * qint64(sizeof(char16_t));
+    if (stateCount == 0 || size != expected)
+        return fail("词典文件大小与头部不符");
+
+    const uchar* p = data + sizeof(Header);
+    const quint16* charMap = reinterpret_cast<const quint16*>(p);
+    p += CHARMAP_SIZE * sizeof(quint16);
+    const qint32* base = reinterpret_cast<const qint32*>(p);
+    p += stateCount * sizeof(qint32);
+    const qint32* check = reinterpret_cast<const qint32*>(p);
+    p += stateCount * sizeof(qint32);
+    const qint32* failLinks = reinterpret_cast<const qint32*>(p);
+    p += stateCount * sizeof(qint32);
+    const qint32* output = reinterpret_cast<const qint32*>(p);
+    p += stateCount * sizeof(qint32);
+    const qint32* depth = reinterpret_cast<const qint32*>(p);
+    p += stateCount * sizeof(qint32);
+    const Entry* entries = reinterpret_cast<const Entry*>(p);
+    p += header->entryCount * sizeof(Entry);
+    const char16_t* pool = reinterpret_cast<const char16_t*>(p);
+
+    // 匹配时不做越界检查，也不防范失败链成环，所以加载时校验下标和状态之间的关系：
+    // 每个状态比父状态深一层，失败指针指向更浅的状态（失败链必然回到根），
+    // 输出词条不长于状态深度（匹配起点不会越过文本开头）
+    const qint64 entryCount = header->entryCount;
+    for (qint64 e = 0; e < entryCount; ++e) {
+        if (entries[e].patternLength == 0
+            || qint64(entries[e].replacementOffset) + entries[e].replacementLength > header->poolLength)
+            return fail("词典词条表已损坏");
+    }
+    if (base[0] < 0 || check[0] != -1 || depth[0] != 0 || output[0] != -1)
+        return fail("词典状态表已损坏");
+    for (qint64 s = 1; s < stateCount; ++s) {
+        if (base[s] < 0 || check[s] < -1 || check[s] >= stateCount)
+            return fail("词典状态表已损坏");
+        if (check[s] == -1)
+            continue;
+
+        const qint32 parent = check[s];
+        const qint32 f = failLinks[s];
+        if ((parent != 0 && check[parent] == -1) || qint64(depth[s]) != qint64(depth[parent]) + 1
+            || f < 0 || f >= stateCount || (f != 0 && check[f] == -1) || depth[f] >= depth[s]
+            || output[s] < -1 || output[s] >= entryCount
+            || (output[s] >= 0 && qint64(entries[output[s]].patternLength) > depth[s]))
+            return fail("词典状态表已损坏");
+    }
+
+    m_header = header;
+    m_charMap = charMap;
+    m_base = base;
+    m_check = check;
+    m_fail = failLinks;
+    m_output = output;
+    m_depth = depth;
+    m_entries = entries;
+    m_pool = pool;
+    return true;
+}
+
+QString HotwordDictionary::process(const QString& text) const
+{
+    Matches matches;
+    scan(text, 0, 0, matches);
+    return apply(text, matches);
+}
+
+qint32 HotwordDictionary::scan(QStringView text, qsizetype offset, qint32 state, Matches& matches) const
+{
+    const qint64 stateCount = m_header->stateCount;
+
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        const quint16 code = m_charMap[text.at(i).unicode()];
+        if (code == 0) {
+            state = 0;
+            continue;
+        }
+
+        for (;;) {
+            const qint64 next = qint64(m_base[state]) + code;
+            if (next < stateCount && m_check[next] == state) {
+                state = qint32(next);
+                break;
+            }
+            if (state == 0)
+                break;
+            state = m_fail[state];
+        }
+
+        if (m_output[state] < 0)
+            continue;
+
+        // 最左最长：新匹配覆盖起点不早于它的已选匹配；若与更早的匹配重叠，
+        // 沿失败链退到更短的词条
+        for (qint32 u = state; u != 0; u = m_fail[u]) {
+            const qint32 entry = m_output[u];
+            if (entry < 0)
+                break;
+
+            const qsizetype end = offset + i + 1;
+            const qsizetype start = end - qsizetype(m_entries[entry].patternLength);
+            qsizetype keep = matches.size();
+            while (keep > 0 && matches[keep - 1].start >= start)
+                --keep;
+            if (keep == 0 || matches[keep - 1].end <= start) {
+                matches.resize(keep);
+                matches.append({ start, end, entry });
+                break;
+            }
+        }
+    }
+    return state;
+}
+
+QString HotwordDictionary::apply(const QString& text, const Matches& matches) const
+{
+    if (matches.isEmpty())
+        return text;
+
+    QString result;
+    result.reserve(text.size());
+    qsizetype pos = 0;
+    for (const Match& match : matches) {
+        result.append(QStringView(text).mid(pos, match.start - pos));
+        result.append(replacement(match.entry));
+        pos = match.end;
+    }
+    result.append(QStringView(text).mid(pos));
+    return result;
+}
+
+QStringView HotwordDictionary::replacement(qint32 entry) const
+{
+    const Entry& e = m_entries[entry];
+    return QStringView(m_pool + e.replacementOffset, qsizetype(e.replacementLength));
+}
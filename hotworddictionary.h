@@ -0,0 +1,92 @@
+#ifndef HOTWORDDICTIONARY_H
+#define HOTWORDDICTIONARY_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include <memory>
+
+// 编译好的 Aho-Corasick 自动机（双数组存储），用于识别结果的热词替换和屏蔽。
+//
+// 二进制映像可以直接内存映射加载，格式如下（本机字节序，4 字节对齐）：
+//   Header
+//   quint16 charMap[65536]        UTF-16 码元 -> 字母表编号，0 表示不在词典中
+//   qint32  base[stateCount]
+//   qint32  check[stateCount]     未使用的槽位为 -1
+//   qint32  fail[stateCount]
+//   qint32  output[stateCount]    在该状态结束的最长词条编号，-1 表示无
+//   qint32  depth[stateCount]     状态在字典树中的深度，加载时用来校验失败指针和词长
+//   Entry   entries[entryCount]
+//   char16_t pool[poolLength]     替换文本
+class HotwordDictionary
+{
+public:
+    using Entries = QList<QPair<QString, QString>>;
+
+    // 匹配位置为文本中的 UTF-16 下标，[start, end)
+    struct Match {
+        qsizetype start;
+        qsizetype end;
+        qint32 entry;
+    };
+    using Matches = QVector<Match>;
+
+    // 词条为 (词, 替换文本)，重复的词以最后一条为准
+    static QByteArray compile(const Entries& entries);
+    // 文本词典每行 "词<TAB>替换"，只有词时用等长的 * 屏蔽；# 开头为注释
+    static bool compileTextFile(const QString& textPath, const QString& binaryPath, QString* error = nullptr);
+
+    static std::shared_ptr<const HotwordDictionary> fromImage(const QByteArray& image, QString* error = nullptr);
+    static std::shared_ptr<const HotwordDictionary> load(const QString& binaryPath, QString* error = nullptr);
+
+    // 一次扫描完成替换，重叠时取最左最长匹配；没有命中时返回原字符串
+    QString process(const QString& text) const;
+
+    // 从 state 继续扫描整段文本中位于 offset 处的 text，新匹配按最左最长规则并入 matches，
+    // 返回扫描结束时的状态。之后产生的匹配只会改动起点不早于 offset + text.size() - depth(state)
+    // 的已有匹配，流式识别据此在片段边界保存扫描进度，修正结果时只需重扫后面的部分
+    qint32 scan(QStringView text, qsizetype offset, qint32 state, Matches& matches) const;
+    QString apply(const QString& text, const Matches& matches) const;
+
+    QStringView replacement(qint32 entry) const;
+    int depth(qint32 state) const { return m_depth[state]; }
+    int entryCount() const { return int(m_header->entryCount); }
+
+private:
+    struct Header {
+        char magic[4];
+        quint32 version;
+        quint32 stateCount;
+        quint32 entryCount;
+        quint32 poolLength;
+        quint32 reserved;
+    };
+
+    struct Entry {
+        quint32 patternLength;
+        quint32 replacementOffset;
+        quint32 replacementLength;
+    };
+
+    HotwordDictionary() = default;
+    bool attach(const uchar* data, qint64 size, QString* error);
+
+    QByteArray m_image;
+    std::unique_ptr<QFile> m_file;
+
+    const Header* m_header = nullptr;
+    const quint16* m_charMap = nullptr;
+    const qint32* m_base = nullptr;
+    const qint32* m_check = nullptr;
+    const qint32* m_fail = nullptr;
+    const qint32* m_output = nullptr;
+    const qint32* m_depth = nullptr;
+    const Entry* m_entries = nullptr;
+    const char16_t* m_pool = nullptr;
+};
+
+#endif // HOTWORDDICTIONARY_H
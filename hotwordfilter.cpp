@@ -0,0 +1,86 @@
+#include "hotwordfilter.h"
+#include <QFileInfo>
+#include <QDebug>
+
+HotwordFilter::HotwordFilter(QObject *parent)
+    : QObject(parent)
+{
+    // 编辑器和编译工具往往连续触发多次变更，合并后只加载一次
+    m_reloadTimer.setSingleShot(true);
+    m_reloadTimer.setInterval(200);
+    connect(&m_reloadTimer, &QTimer::timeout, this, &HotwordFilter::reload);
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, &HotwordFilter::onFileChanged);
+}
+
+bool HotwordFilter::load(const QString& path)
+{
+    QString error;
+    std::shared_ptr<const HotwordDictionary> dictionary = HotwordDictionary::load(path, &error);
+    if (!dictionary) {
+        qDebug() << "Failed to load hotword dictionary" << path << ":" << error;
+        return false;
+    }
+
+    if (!m_path.isEmpty())
+        m_watcher.removePath(m_path);
+    m_path = path;
+    m_binaryPath.clear();
+    m_watcher.addPath(m_path);
+
+    m_dictionary = std::move(dictionary);
+    qDebug() << "Loaded hotword dictionary" << path << "with" << m_dictionary->entryCount() << "entries";
+    return true;
+}
+
+bool HotwordFilter::loadTextFile(const QString& textPath, const QString& binaryPath)
+{
+    QString error;
+    if (!HotwordDictionary::compileTextFile(textPath, binaryPath, &error)) {
+        qDebug() << "Failed to compile hotword dictionary" << textPath << ":" << error;
+        return false;
+    }
+    if (!load(binaryPath))
+        return false;
+
+    m_watcher.removePath(m_path);
+    m_path = textPath;
+    m_binaryPath = binaryPath;
+    m_watcher.addPath(m_path);
+    return true;
+}
+
+QString HotwordFilter::process(const QString& text) const
+{
+    if (!m_dictionary)
+        return text;
+    return m_dictionary->process(text);
+}
+
+void HotwordFilter::onFileChanged(const QString& path)
+{
+    Q_UNUSED(path);
+    m_reloadTimer.start();
+}
+
+void HotwordFilter::reload()
+{
+    // 原子替换会让监视路径失效，需要重新添加
+    if (!m_watcher.files().contains(m_path) && QFileInfo::exists(m_path))
+        m_watcher.addPath(m_path);
+
+    QString error;
+    if (!m_binaryPath.isEmpty() && !HotwordDictionary::compileTextFile(m_path, m_binaryPath, &error)) {
+        qDebug() << "Hotword dictionary recompile failed, keeping previous one:" << error;
+        return;
+    }
+
+    const QString binaryPath = m_binaryPath.isEmpty() ? m_path : m_binaryPath;
+    std::shared_ptr<const HotwordDictionary> dictionary = HotwordDictionary::load(binaryPath, &error);
+    if (!dictionary) {
+        qDebug() << "Hotword dictionary reload failed, keeping previous one:" << error;
+        return;
+    }
+
+    m_dictionary = std::move(dictionary);
+    qDebug() << "Reloaded hotword dictionary with" << m_dictionary->entryCount() << "entries";
+}
@@ -0,0 +1,43 @@
+#ifndef HOTWORDFILTER_H
+#define HOTWORDFILTER_H
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <memory>
+
+#include "hotworddictionary.h"
+
+// 识别结果的后处理阶段：按词典做热词替换和敏感词屏蔽。
+// 词典可由多个会话共用；wpgs 片段需拼回整句再匹配，跨片段的词才能命中，
+// 这部分状态按会话保存在 HotwordStream 中。词典文件被替换后自动重新加载，
+// 新自动机就绪前继续使用旧的，识别不会中断。
+class HotwordFilter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HotwordFilter(QObject *parent = nullptr);
+
+    // 加载编译好的二进制词典并监视其变化
+    bool load(const QString& path);
+    // 把文本词典编译到 binaryPath 后加载；监视的是文本文件，修改后重新编译
+    bool loadTextFile(const QString& textPath, const QString& binaryPath);
+    QString process(const QString& text) const;
+    // 当前词典，未加载时为空；重载后旧词典在持有者释放前保持有效
+    std::shared_ptr<const HotwordDictionary> dictionary() const { return m_dictionary; }
+
+private slots:
+    void onFileChanged(const QString& path);
+    void reload();
+
+private:
+    std::shared_ptr<const HotwordDictionary> m_dictionary;
+    QFileSystemWatcher m_watcher;
+    QTimer m_reloadTimer;
+    // 监视的文件；来自文本词典时另有编译输出的二进制文件
+    QString m_path;
+    QString m_binaryPath;
+};
+
+#endif // HOTWORDFILTER_H
@@ -0,0 +1,220 @@
+#include "hotwordstream.h"
+#include <algorithm>
+
+HotwordStream::HotwordStream(const HotwordFilter* filter)
+    : m_filter(filter)
+    , m_sealedParts(0)
+{
+}
+
+void HotwordStream::setFilter(const HotwordFilter* filter)
+{
+    m_filter = filter;
+}
+
+QVector<RecognitionSegment> HotwordStream::update(const RecognitionSegment& segment)
+{
+    qsizetype edited = m_parts.size();
+    for (qsizetype i = m_parts.size() - 1; i >= 0; --i) {
+        const int sn = m_parts.at(i).segment.sn;
+        const bool replaced = segment.progressive == RecognitionSegment::Progressive::Replace
+                              && sn >= segment.replaceBegin && sn <= segment.replaceEnd;
+        if (replaced || sn == segment.sn) {
+            m_parts.remove(i);
+            edited = qMin(edited, i);
+        }
+    }
+
+    const auto pos = std::find_if(m_parts.begin(), m_parts.end(),
+                                  [&segment](const Part& part) { return part.segment.sn > segment.sn; });
+    Part part;
+    part.segment = segment;
+    part.text = QString::fromUtf8(segment.text);
+    part.wordLengths.reserve(segment.words.size());
+    for (qsizetype i = 0; i < segment.words.size(); ++i)
+        part.wordLengths.append(QString::fromUtf8(segment.wordText(i)).size());
+    const qsizetype current = pos - m_parts.begin();
+    m_parts.insert(current, part);
+    edited = qMin(edited, current);
+    m_sealedParts = qMin(m_sealedParts, edited);
+
+    // 词典重载后之前保存的状态都已失效，整句重扫
+    qsizetype first = edited;
+    std::shared_ptr<const HotwordDictionary> dictionary = m_filter ? m_filter->dictionary() : nullptr;
+    if (dictionary != m_dictionary) {
+        m_dictionary = std::move(dictionary);
+        first = 0;
+    }
+
+    rescan(first);
+
+    const qsizetype from = qMax(firstAffectedPart(first), qMin(m_sealedParts, edited));
+    QVector<RecognitionSegment> segments;
+    buildSegments(from, segments);
+
+    RecognitionSegment own = segments.takeAt(current - from);
+    own.isLast = segment.isLast;
+    own.progressive = segment.progressive;
+    own.replaceBegin = segment.replaceBegin;
+    own.replaceEnd = segment.replaceEnd;
+    if (segment.progressive == RecognitionSegment::Progressive::Append) {
+        // 上一片段结尾停在某个热词的前缀上时，后续结果还可能与之拼成热词
+        if (current > 0 && m_dictionary && m_dictionary->depth(m_parts.at(current - 1).state) != 0) {
+            own.progressive = RecognitionSegment::Progressive::Replace;
+            own.replaceBegin = segment.sn;
+            own.replaceEnd = segment.sn;
+        } else {
+            m_sealedParts = current;
+        }
+    }
+    segments.append(own);
+    return segments;
+}
+
+QString HotwordStream::text() const
+{
+    return m_dictionary ? m_dictionary->apply(m_text, m_matches) : m_text;
+}
+
+void HotwordStream::reset()
+{
+    m_parts.clear();
+    m_text.clear();
+    m_matches.clear();
+    m_sealedParts = 0;
+}
+
+void HotwordStream::rescan(qsizetype first)
+{
+    // 已定的匹配仍在 m_matches 开头，接上保存的未定匹配即恢复到该片段结尾时的进度
+    qsizetype offset = 0;
+    qint32 state = 0;
+    if (first > 0) {
+        const Part& previous = m_parts.at(first - 1);
+        offset = previous.end;
+        state = previous.state;
+        m_matches.resize(previous.settledMatches);
+        m_matches.append(previous.openMatches);
+    } else {
+        m_matches.clear();
+    }
+    m_text.truncate(offset);
+
+    for (qsizetype i = first; i < m_parts.size(); ++i) {
+        Part& part = m_parts[i];
+        m_text.append(part.text);
+        if (m_dictionary)
+            state = m_dictionary->scan(part.text, offset, state, m_matches);
+        offset += part.text.size();
+
+        // 起点早于 offset - depth 的匹配之后不会再变，只需保存其余的
+        const qsizetype limit = offset - (m_dictionary ? m_dictionary->depth(state) : 0);
+        const auto open = std::find_if(m_matches.cbegin(), m_matches.cend(),
+                                       [limit](const HotwordDictionary::Match& match) { return match.start >= limit; });
+        part.end = offset;
+        part.state = state;
+        part.settledMatches = open - m_matches.cbegin();
+        part.openMatches = HotwordDictionary::Matches(open, m_matches.cend());
+    }
+}
+
+qsizetype HotwordStream::partStart(qsizetype index) const
+{
+    return index > 0 ? m_parts.at(index - 1).end : 0;
+}
+
+qsizetype HotwordStream::firstAffectedPart(qsizetype first) const
+{
+    if (first == 0 || !m_dictionary)
+        return first;
+
+    // 重扫只会改动起点不早于 limit 的匹配
+    const Part& previous = m_parts.at(first - 1);
+    const qsizetype limit = previous.end - m_dictionary->depth(previous.state);
+    qsizetype from = first;
+    while (from > 0 && partStart(from) > limit)
+        --from;
+
+    // 跨过片段开头的匹配把之前片段的词并进了同一组，从组首所在的片段开始
+    for (;;) {
+        const qsizetype start = partStart(from);
+        const auto next = std::partition_point(m_matches.cbegin(), m_matches.cend(),
+                                               [start](const HotwordDictionary::Match& match) { return match.start < start; });
+        if (next == m_matches.cbegin() || (next - 1)->end <= start)
+            break;
+        while (partStart(from) > (next - 1)->start)
+            --from;
+    }
+    return from;
+}
+
+void HotwordStream::buildSegments(qsizetype from, QVector<RecognitionSegment>& segments) const
+{
+    struct WordRef {
+        qsizetype part;
+        qsizetype index;
+        qsizetype start;
+        qsizetype end;
+    };
+
+    QVector<WordRef> words;
+    for (qsizetype p = from; p < m_parts.size(); ++p) {
+        const Part& part = m_parts.at(p);
+        RecognitionSegment segment;
+        segment.sn = part.segment.sn;
+        segment.progressive = RecognitionSegment::Progressive::Replace;
+        segment.replaceBegin = segment.sn;
+        segment.replaceEnd = segment.sn;
+        segments.append(segment);
+
+        qsizetype pos = partStart(p);
+        for (qsizetype i = 0; i < part.wordLengths.size(); ++i) {
+            words.append({ p, i, pos, pos + part.wordLengths.at(i) });
+            pos += part.wordLengths.at(i);
+        }
+    }
+
+    const qsizetype textStart = partStart(from);
+    auto match = std::partition_point(m_matches.cbegin(), m_matches.cend(),
+                                      [textStart](const HotwordDictionary::Match& m) { return m.start < textStart; });
+    for (qsizetype w = 0; w < words.size();) {
+        // 与同一串匹配重叠的相邻词合并为一组
+        const auto groupMatches = match;
+        qsizetype last = w;
+        while (match != m_matches.cend() && match->start < words.at(last).end) {
+            while (words.at(last).end < match->end)
+                ++last;
+            ++match;
+        }
+
+        const WordRef& head = words.at(w);
+        const RecognitionSegment& source = m_parts.at(head.part).segment;
+        RecognitionWord word = source.words.at(head.index);
+        QByteArray text;
+        if (groupMatches == match) {
+            text = source.wordText(head.index).toByteArray();
+        } else {
+            const WordRef& tail = words.at(last);
+            QString replaced;
+            qsizetype pos = head.start;
+            for (auto m = groupMatches; m != match; ++m) {
+                replaced.append(QStringView(m_text).mid(pos, m->start - pos));
+                replaced.append(m_dictionary->replacement(m->entry));
+                pos = m->end;
+            }
+            replaced.append(QStringView(m_text).mid(pos, tail.end - pos));
+            text = replaced.toUtf8();
+            word.endMs = m_parts.at(tail.part).segment.words.at(tail.index).endMs;
+        }
+        w = last + 1;
+
+        // 替换为空的词条相当于删除，与服务端的空词一样不输出
+        if (text.isEmpty())
+            continue;
+        RecognitionSegment& segment = segments[head.part - from];
+        word.textOffset = quint32(segment.text.size());
+        word.textLength = quint32(text.size());
+        segment.text.append(text);
+        segment.words.append(word);
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef HOTWORDSTREAM_H
+#define HOTWORDSTREAM_H
+
+#include <QString>
+#include <QVector>
+#include <memory>
+
+#include "hotworddictionary.h"
+#include "hotwordfilter.h"
+#include "recognitionresult.h"
+
+// 单个识别会话的热词匹配状态。wpgs 结果按 sn 拼回当前整句（apd 追加、rpl 替换 rg 范围），
+// 每个 sn 片段结束处保存自动机状态和尚可能被改动的匹配，服务端修正某个片段时
+// 只从该片段起重新扫描，结果与整句重扫一致，跨片段的热词也能命中。
+//
+// 结构化结果同样经过替换：命中热词的几个词合并成一个词，时间取首词开始到末词结束，
+// 归入首词所在的片段。热词跨片段时之前的片段会以 Replace（rg 为该片段自身）重发，
+// 可能早于服务端的 apd；因此只有之前的片段不会再变时才原样转发 apd，否则改为
+// Replace，下游收到 apd 时仍可把之前的结果视为定稿。
+class HotwordStream
+{
+public:
+    explicit HotwordStream(const HotwordFilter* filter = nullptr);
+
+    void setFilter(const HotwordFilter* filter);
+
+    // 并入一条识别结果，返回需要发出的结构化结果：受影响的之前片段在前，本条在最后
+    QVector<RecognitionSegment> update(const RecognitionSegment& segment);
+    // 替换后的当前整句
+    QString text() const;
+    // 开始新的一句（新会话或一句结束后）
+    void reset();
+
+private:
+    struct Part {
+        RecognitionSegment segment;
+        QString text;
+        // 每个词的 UTF-16 长度，用来把匹配位置对应到词
+        QVector<qsizetype> wordLengths;
+        // 以下为扫描到本片段结尾时的进度
+        qsizetype end = 0;
+        qint32 state = 0;
+        qsizetype settledMatches = 0;
+        HotwordDictionary::Matches openMatches;
+    };
+
+    void rescan(qsizetype first);
+    qsizetype partStart(qsizetype index) const;
+    qsizetype firstAffectedPart(qsizetype first) const;
+    void buildSegments(qsizetype from, QVector<RecognitionSegment>& segments) const;
+
+    const HotwordFilter* m_filter;
+    std::shared_ptr<const HotwordDictionary> m_dictionary;
+    QVector<Part> m_parts;
+    QString m_text;
+    HotwordDictionary::Matches m_matches;
+    // 之前的片段已作为最终结果发出，不再重发
+    qsizetype m_sealedParts;
+};
+
+#endif // HOTWORDSTREAM_H
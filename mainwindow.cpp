@@ -1,18 +1,124 @@
 #include "mainwindow.h"
 #include <QVBoxLayout>
 #include <QMessageBox>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QDateTime>
+#include <QFile>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
+    , meetingMode(false)
+    , subtitleFormat(SubtitleWriter::Format::Srt)
 {
     setupUI();
+    // 单通道和会议会话共用一个票据缓存，同一张票据不会被两边各用一次，也不会互相覆盖存储文件
+    tlsSessionCache = new TlsSessionCache(this);
+    tlsSessionCache->setStorePath(
+        QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/tls_sessions.dat");
+    // 热词词典同样共用；XFYUN_HOTWORDS 可指向文本词典（.txt，自动编译）或编译好的二进制文件
+    hotwordFilter = new HotwordFilter(this);
+    if (qEnvironmentVariableIsSet("XFYUN_HOTWORDS"))
+        loadHotwords(qEnvironmentVariable("XFYUN_HOTWORDS"));
+
     speechClient = new SpeechClient(this);
+    speechClient->setTlsSessionCache(tlsSessionCache);
+    speechClient->setHotwordFilter(hotwordFilter);
+    if (qEnvironmentVariableIsSet("XFYUN_IAT_URL"))
+        speechClient->setServerUrl(QUrl(qEnvironmentVariable("XFYUN_IAT_URL")));
 
     connect(startButton, &QPushButton::clicked, this, &MainWindow::onStartButtonClicked);
     connect(stopButton, &QPushButton::clicked, this, &MainWindow::onStopButtonClicked);
     connect(speechClient, &SpeechClient::recognitionResult, this, &MainWindow::onRecognitionResult);
     connect(speechClient, &SpeechClient::connectionError, this, &MainWindow::onConnectionError);
     connect(speechClient, &SpeechClient::statusChanged, this, &MainWindow::onStatusChanged);
+    connect(speechClient, &SpeechClient::recognitionSegment, this, [this](const RecognitionSegment& segment) {
+        addSubtitleSegment(-1, segment);
+    });
+
+    meetingTranscriber = new MeetingTranscriber(this);
+    meetingTranscriber->setTlsSessionCache(tlsSessionCache);
+    meetingTranscriber->setHotwordFilter(hotwordFilter);
+    connect(meetingTranscriber, &MeetingTranscriber::recognitionResult, this, &MainWindow::onChannelResult);
+    connect(meetingTranscriber, &MeetingTranscriber::connectionError, this, &MainWindow::onChannelError);
+    connect(meetingTranscriber, &MeetingTranscriber::statusChanged, this, &MainWindow::onStatusChanged);
+    connect(meetingTranscriber, &MeetingTranscriber::recognitionSegment, this, &MainWindow::addSubtitleSegment);
+
+    // 字幕导出：XFYUN_SUBTITLE_DIR 指定输出目录，XFYUN_SUBTITLE_FORMAT=vtt 时输出 WebVTT，默认 SRT
+    subtitleDir = qEnvironmentVariable("XFYUN_SUBTITLE_DIR");
+    if (qEnvironmentVariable("XFYUN_SUBTITLE_FORMAT").compare("vtt", Qt::CaseInsensitive) == 0)
+        subtitleFormat = SubtitleWriter::Format::WebVtt;
+}
+
+MainWindow::~MainWindow()
+{
+    closeSubtitles();
+}
+
+void MainWindow::loadHotwords(const QString& path)
+{
+    bool loaded;
+    if (path.endsWith(".txt", Qt::CaseInsensitive)) {
+        const QString binaryPath =
+            QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/hotwords.bin";
+        QDir().mkpath(QFileInfo(binaryPath).absolutePath());
+        loaded = hotwordFilter->loadTextFile(path, binaryPath);
+    } else {
+        loaded = hotwordFilter->load(path);
+    }
+    if (!loaded)
+        statusLabel->setText(QString("热词词典加载失败: %1").arg(path));
+}
+
+void MainWindow::openSubtitles(const QList<QAudioDevice>& sources)
+{
+    // 上一次识别的最后一条字幕在这里写出；停止后仍可能收到最终结果，所以不在停止时关闭
+    closeSubtitles();
+    if (subtitleDir.isEmpty())
+        return;
+
+    QDir().mkpath(subtitleDir);
+    const QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss");
+    const QString suffix = subtitleFormat == SubtitleWriter::Format::WebVtt ? "vtt" : "srt";
+    const int count = sources.isEmpty() ? 1 : sources.size();
+    for (int i = 0; i < count; ++i) {
+        const int source = sources.isEmpty() ? -1 : i;
+        const QString name = sources.isEmpty()
+            ? QString("subtitles-%1.%2").arg(stamp, suffix)
+            : QString("subtitles-%1-%2.%3").arg(stamp).arg(i + 1).arg(suffix);
+
+        QFile* file = new QFile(QDir(subtitleDir).filePath(name), this);
+        if (!file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            statusLabel->setText(QString("无法写入字幕文件: %1").arg(file->fileName()));
+            delete file;
+            continue;
+        }
+        subtitleFiles.insert(source, file);
+        subtitleWriters.insert(source, new SubtitleWriter(file, subtitleFormat));
+    }
+}
+
+void MainWindow::closeSubtitles()
+{
+    for (SubtitleWriter* writer : std::as_const(subtitleWriters)) {
+        writer->finish();
+        delete writer;
+    }
+    subtitleWriters.clear();
+    for (QFile* file : std::as_const(subtitleFiles)) {
+        file->close();
+        delete file;
+    }
+    subtitleFiles.clear();
+}
+
+void MainWindow::addSubtitleSegment(int source, const RecognitionSegment& segment)
+{
+    if (SubtitleWriter* writer = subtitleWriters.value(source))
+        writer->addSegment(segment);
 }
 
 void MainWindow::setupUI()
@@ -31,6 +137,13 @@ void MainWindow::setupUI()
 
     statusLabel = new QLabel("就绪", this);
 
+    // 只勾选默认麦克风时走单通道识别，勾选多个或其他设备时按设备分别识别
+    deviceList = new QListWidget(this);
+    deviceList->setMaximumHeight(100);
+    populateDevices();
+
+    layout->addWidget(new QLabel("麦克风", this));
+    layout->addWidget(deviceList);
     layout->addWidget(startButton);
     layout->addWidget(stopButton);
     layout->addWidget(resultText);
@@ -40,24 +153,84 @@ void MainWindow::setupUI()
     setWindowTitle("科大讯飞语音识别");
 }
 
+void MainWindow::populateDevices()
+{
+    const QAudioDevice defaultDevice = QMediaDevices::defaultAudioInput();
+    for (const QAudioDevice& device : QMediaDevices::audioInputs()) {
+        QListWidgetItem* item = new QListWidgetItem(device.description(), deviceList);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(device == defaultDevice ? Qt::Checked : Qt::Unchecked);
+        item->setData(Qt::UserRole, QVariant::fromValue(device));
+    }
+}
+
+QList<QAudioDevice> MainWindow::selectedDevices() const
+{
+    QList<QAudioDevice> devices;
+    for (int i = 0; i < deviceList->count(); ++i) {
+        const QListWidgetItem* item = deviceList->item(i);
+        if (item->checkState() == Qt::Checked)
+            devices.append(item->data(Qt::UserRole).value<QAudioDevice>());
+    }
+    return devices;
+}
+
 void MainWindow::onStartButtonClicked()
 {
+    const QList<QAudioDevice> devices = selectedDevices();
+    if (devices.isEmpty()) {
+        QMessageBox::warning(this, "错误", "请至少选择一个麦克风");
+        return;
+    }
+
     startButton->setEnabled(false);
     stopButton->setEnabled(true);
+    deviceList->setEnabled(false);
     resultText->clear();
-    speechClient->startRecognition();
+    openBlocks.clear();
+
+    meetingMode = devices.size() > 1 || devices.first() != QMediaDevices::defaultAudioInput();
+    openSubtitles(meetingMode ? devices : QList<QAudioDevice>());
+    if (meetingMode) {
+        meetingDevices = devices;
+        meetingTranscriber->setDevices(devices);
+        meetingTranscriber->start();
+    } else {
+        speechClient->startRecognition();
+    }
 }
 
 void MainWindow::onStopButtonClicked()
 {
     stopButton->setEnabled(false);
     startButton->setEnabled(true);
-    speechClient->stopRecognition();
+    deviceList->setEnabled(true);
+    if (meetingMode)
+        meetingTranscriber->stop();
+    else
+        speechClient->stopRecognition();
 }
 
-void MainWindow::onRecognitionResult(const QString& text)
+void MainWindow::onRecognitionResult(const QString& text, bool isFinal)
 {
-    resultText->append(text);
+    showResult(-1, text, isFinal);
+}
+
+void MainWindow::showResult(int source, const QString& line, bool isFinal)
+{
+    // 识别中的句子会被服务端修正，原地替换所在段落而不是追加新行
+    const auto open = openBlocks.constFind(source);
+    if (open != openBlocks.constEnd()) {
+        QTextCursor cursor(resultText->document()->findBlockByNumber(open.value()));
+        cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+        cursor.insertText(line);
+    } else if (!line.isEmpty()) {
+        resultText->append(line);
+        openBlocks.insert(source, resultText->document()->blockCount() - 1);
+    }
+
+    if (isFinal)
+        openBlocks.remove(source);
 }
 
 void MainWindow::onConnectionError(const QString& error)
@@ -65,6 +238,20 @@ void MainWindow::onConnectionError(const QString& error)
     QMessageBox::warning(this, "错误", error);
     stopButton->setEnabled(false);
     startButton->setEnabled(true);
+    deviceList->setEnabled(true);
+}
+
+void MainWindow::onChannelResult(int channel, const QString& text, bool isFinal)
+{
+    const QString line = text.isEmpty() ? QString() : QString("[%1] %2").arg(meetingDevices.value(channel).description(), text);
+    showResult(channel, line, isFinal);
+}
+
+void MainWindow::onChannelError(int channel, const QString& error)
+{
+    // 单个通道出错不影响其余通道，只提示不停止
+    const QString source = channel >= 0 ? meetingDevices.value(channel).description() : QString("采集");
+    statusLabel->setText(QString("[%1] %2").arg(source, error));
 }
 
 void MainWindow::onStatusChanged(const QString& status)
@@ -5,7 +5,11 @@
 #include <QPushButton>
 #include <QTextEdit>
 #include <QLabel>
+#include <QListWidget>
+#include <QHash>
+#include "meetingtranscriber.h"
 #include "speechclient.h"
+#include "subtitlewriter.h"
 
 class MainWindow : public QMainWindow
 {
@@ -13,22 +17,45 @@ class MainWindow : public QMainWindow
 
 public:
     explicit MainWindow(QWidget *parent = nullptr);
+    ~MainWindow();
 
 private slots:
     void onStartButtonClicked();
     void onStopButtonClicked();
-    void onRecognitionResult(const QString& text);
+    void onRecognitionResult(const QString& text, bool isFinal);
     void onConnectionError(const QString& error);
     void onStatusChanged(const QString& status);
+    void onChannelResult(int channel, const QString& text, bool isFinal);
+    void onChannelError(int channel, const QString& error);
 
 private:
     void setupUI();
+    void populateDevices();
+    QList<QAudioDevice> selectedDevices() const;
+    void showResult(int source, const QString& line, bool isFinal);
+    void loadHotwords(const QString& path);
+    void openSubtitles(const QList<QAudioDevice>& sources);
+    void closeSubtitles();
+    void addSubtitleSegment(int source, const RecognitionSegment& segment);
 
     QPushButton* startButton;
     QPushButton* stopButton;
     QTextEdit* resultText;
     QLabel* statusLabel;
+    QListWidget* deviceList;
+    TlsSessionCache* tlsSessionCache;
+    HotwordFilter* hotwordFilter;
     SpeechClient* speechClient;
+    MeetingTranscriber* meetingTranscriber;
+    QList<QAudioDevice> meetingDevices;
+    // 每个来源（-1 为单通道）尚未结束的那一句所在的段落号
+    QHash<int, int> openBlocks;
+    // 设置了 XFYUN_SUBTITLE_DIR 时每个来源写一个字幕文件
+    QString subtitleDir;
+    SubtitleWriter::Format subtitleFormat;
+    QHash<int, QFile*> subtitleFiles;
+    QHash<int, SubtitleWriter*> subtitleWriters;
+    bool meetingMode;
 };
 
 #endif // MAINWINDOW_H
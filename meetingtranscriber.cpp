@@ -0,0 +1,159 @@
+#include "meetingtranscriber.h"
+#include <QDebug>
+#include <QTimer>
+
+#if QT_CONFIG(permissions)
+#include <QCoreApplication>
+#include <QPermission>
+#endif
+
+MeetingTranscriber::MeetingTranscriber(QObject *parent)
+    : QObject(parent)
+    , m_scheduler(new CaptureScheduler(this))
+    , m_tlsSessionCache(new TlsSessionCache(this))
+    , m_hotwordFilter(new HotwordFilter(this))
+    , m_isRunning(false)
+{
+    connect(m_scheduler, &CaptureScheduler::frameReady, this,
+            [this](int channel, qint64 timestamp, const QByteArray& pcm) {
+                if (channel >= 0 && channel < m_sessions.size())
+                    m_sessions.at(channel)->feedAudio(pcm, timestamp);
+            });
+    connect(m_scheduler, &CaptureScheduler::channelActiveChanged, this,
+            [](int channel, bool active) {
+                qDebug() << "Channel" << channel << (active ? "active" : "inactive");
+            });
+    connect(m_scheduler, &CaptureScheduler::captureError, this,
+            [this](const QString& error) {
+                emit connectionError(-1, error);
+            });
+}
+
+MeetingTranscriber::~MeetingTranscriber()
+{
+    stop();
+}
+
+void MeetingTranscriber::setDevices(const QList<QAudioDevice>& devices)
+{
+    stop();
+
+    // 停止后会话仍有延迟关闭 WebSocket 的定时器，交给事件循环删除
+    for (SpeechClient* session : std::as_const(m_sessions)) {
+        session->disconnect(this);
+        session->deleteLater();
+    }
+    m_sessions.clear();
+
+    for (int i = 0; i < devices.size(); ++i) {
+        SpeechClient* session = new SpeechClient(this, false);
+        session->setTlsSessionCache(m_tlsSessionCache);
+        session->setHotwordFilter(m_hotwordFilter);
+
+        connect(session, &SpeechClient::recognitionResult, this, [this, i](const QString& text, bool isFinal) {
+            emit recognitionResult(i, text, isFinal);
+        });
+        connect(session, &SpeechClient::recognitionSegment, this, [this, i](const RecognitionSegment& segment) {
+            emit recognitionSegment(i, segment);
+        });
+        connect(session, &SpeechClient::connectionError, this, [this, i](const QString& error) {
+            emit connectionError(i, error);
+        });
+        connect(session, &SpeechClient::sessionClosed, this, [this, session]() {
+            restartSession(session);
+        });
+        m_sessions.append(session);
+    }
+
+    m_scheduler->setDevices(devices);
+}
+
+void MeetingTranscriber::setTlsSessionStorePath(const QString& path)
+{
+    m_tlsSessionCache->setStorePath(path);
+}
+
+void MeetingTranscriber::setTlsSessionCache(TlsSessionCache* cache)
+{
+    if (m_tlsSessionCache->parent() == this)
+        delete m_tlsSessionCache;
+    m_tlsSessionCache = cache;
+    for (SpeechClient* session : std::as_const(m_sessions))
+        session->setTlsSessionCache(cache);
+}
+
+void MeetingTranscriber::setHotwordFilter(HotwordFilter* filter)
+{
+    if (m_hotwordFilter->parent() == this)
+        delete m_hotwordFilter;
+    m_hotwordFilter = filter;
+    for (SpeechClient* session : std::as_const(m_sessions))
+        session->setHotwordFilter(filter);
+}
+
+bool MeetingTranscriber::setHotwordDictionary(const QString& path)
+{
+    return m_hotwordFilter->load(path);
+}
+
+void MeetingTranscriber::start()
+{
+#if QT_CONFIG(permissions)
+    QMicrophonePermission microphonePermission;
+    switch (qApp->checkPermission(microphonePermission)) {
+    case Qt::PermissionStatus::Undetermined:
+        qApp->requestPermission(microphonePermission, this, &MeetingTranscriber::start);
+        return;
+    case Qt::PermissionStatus::Denied:
+        qWarning("Microphone permission is not granted!");
+        emit connectionError(-1, "麦克风权限未获授权，语音识别无法工作");
+        return;
+    case Qt::PermissionStatus::Granted:
+        break;
+    }
+#endif
+
+    startCapture();
+}
+
+void MeetingTranscriber::startCapture()
+{
+    if (m_isRunning || m_sessions.isEmpty()) {
+        return;
+    }
+
+    m_isRunning = true;
+    for (SpeechClient* session : std::as_const(m_sessions))
+        session->startRecognition();
+    m_scheduler->start();
+
+    emit statusChanged(QString("正在采集 %1 路麦克风").arg(m_sessions.size()));
+}
+
+void MeetingTranscriber::restartSession(SpeechClient* session)
+{
+    if (!m_isRunning)
+        return;
+
+    // 延迟重连，避免服务端持续拒绝时空转；期间的音频由会话缓存，连上后补发
+    QTimer::singleShot(RESTART_DELAY_MS, session, [this, session]() {
+        if (m_isRunning && !session->isActive()) {
+            qDebug() << "Restarting recognition session" << m_sessions.indexOf(session);
+            session->startRecognition();
+        }
+    });
+}
+
+void MeetingTranscriber::stop()
+{
+    if (!m_isRunning) {
+        return;
+    }
+
+    m_isRunning = false;
+    m_scheduler->stop();
+    for (SpeechClient* session : std::as_const(m_sessions))
+        session->stopRecognition();
+
+    emit statusChanged("停止识别");
+}
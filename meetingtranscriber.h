@@ -0,0 +1,53 @@
+#ifndef MEETINGTRANSCRIBER_H
+#define MEETINGTRANSCRIBER_H
+
+#include <QObject>
+#include <QList>
+#include <QAudioDevice>
+
+#include "capturescheduler.h"
+#include "speechclient.h"
+
+// 多麦克风会议转写：每个设备对应一个独立的识别会话，
+// 音频由共享的 CaptureScheduler 采集并按通道分发，
+// TLS 票据缓存和热词词典由所有会话共用。服务端结束某个会话（一句话结束、
+// 空闲超时或时长上限）后，只要仍在采集就为该通道重新建连。
+class MeetingTranscriber : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MeetingTranscriber(QObject *parent = nullptr);
+    ~MeetingTranscriber();
+
+    void setDevices(const QList<QAudioDevice>& devices);
+    void setTlsSessionStorePath(const QString& path);
+    // 与单通道识别共用同一个票据缓存时注入，调用方负责其生命周期
+    void setTlsSessionCache(TlsSessionCache* cache);
+    bool setHotwordDictionary(const QString& path);
+    // 与单通道识别共用同一个热词过滤器时注入，调用方负责其生命周期
+    void setHotwordFilter(HotwordFilter* filter);
+
+    void start();
+    void stop();
+
+signals:
+    void recognitionResult(int channel, const QString& text, bool isFinal);
+    void recognitionSegment(int channel, const RecognitionSegment& segment);
+    void connectionError(int channel, const QString& error);
+    void statusChanged(const QString& status);
+
+private:
+    void startCapture();
+    void restartSession(SpeechClient* session);
+
+    CaptureScheduler* m_scheduler;
+    TlsSessionCache* m_tlsSessionCache;
+    HotwordFilter* m_hotwordFilter;
+    QList<SpeechClient*> m_sessions;
+    bool m_isRunning;
+
+    static constexpr int RESTART_DELAY_MS = 1000;
+};
+
+#endif // MEETINGTRANSCRIBER_H
@@ -0,0 +1,67 @@
+#include "recognitionresult.h"
+#include <QJsonArray>
+
+namespace {
+// 讯飞返回的 bg/ed 以帧为单位，1 帧 = 10ms
+const int MS_PER_FRAME = 10;
+}
+
+RecognitionSegment RecognitionSegment::fromJson(const QJsonObject& result, qint32 previousEndMs, qint32 audioEndMs)
+{
+    RecognitionSegment segment;
+    segment.sn = result["sn"].toInt();
+    segment.isLast = result["ls"].toBool();
+
+    const QString pgs = result["pgs"].toString();
+    if (pgs == "apd") {
+        segment.progressive = Progressive::Append;
+    } else if (pgs == "rpl") {
+        segment.progressive = Progressive::Replace;
+        const QJsonArray rg = result["rg"].toArray();
+        segment.replaceBegin = rg.at(0).toInt();
+        segment.replaceEnd = rg.at(1).toInt();
+    }
+
+    const QJsonArray ws = result["ws"].toArray();
+    segment.words.reserve(ws.size());
+    for (const QJsonValue& w : ws) {
+        const QJsonArray cw = w["cw"].toArray();
+        if (cw.isEmpty())
+            continue;
+
+        const QByteArray utf8 = cw.first()["w"].toString().toUtf8();
+        if (utf8.isEmpty())
+            continue;
+
+        RecognitionWord word;
+        word.textOffset = quint32(segment.text.size());
+        word.textLength = quint32(utf8.size());
+        word.beginMs = w["bg"].toInt() * MS_PER_FRAME;
+        segment.text.append(utf8);
+        segment.words.append(word);
+    }
+
+    // 服务端只给出每个词的起点，终点取下一个有时间的词的起点，之后没有则用 ed，
+    // ed 未给出时用已发送的音频时长；没有时间的词（bg 为 0，一般是标点）不占时长，贴在前一个词的结尾
+    const qint32 edMs = result["ed"].toInt() * MS_PER_FRAME;
+    qint32 nextBeginMs = edMs > 0 ? edMs : audioEndMs;
+    qint32 previousEnd = previousEndMs;
+    for (qsizetype i = segment.words.size() - 1; i >= 0; --i) {
+        RecognitionWord& word = segment.words[i];
+        if (word.beginMs > 0) {
+            word.endMs = qMax(word.beginMs, nextBeginMs);
+            nextBeginMs = word.beginMs;
+            previousEnd = qMin(previousEndMs, word.beginMs);
+        }
+    }
+    for (RecognitionWord& word : segment.words) {
+        if (word.beginMs > 0) {
+            previousEnd = word.endMs;
+        } else {
+            word.beginMs = previousEnd;
+            word.endMs = previousEnd;
+        }
+    }
+
+    return segment;
+}
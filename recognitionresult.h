@@ -0,0 +1,47 @@
+#ifndef RECOGNITIONRESULT_H
+#define RECOGNITIONRESULT_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QJsonObject>
+#include <QMetaType>
+#include <QVector>
+
+// 单个词：指向所属片段 UTF-8 文本中的一段。fromJson 给出的时间相对于发给服务端的音频，
+// SpeechClient 发出前会换算到采集时间轴（跳过的静音不计入服务端时间）
+struct RecognitionWord {
+    quint32 textOffset = 0;
+    quint32 textLength = 0;
+    qint32 beginMs = 0;
+    qint32 endMs = 0;
+};
+
+// 一条识别结果（对应服务端的一个 sn），所有词共用同一个文本缓冲区
+struct RecognitionSegment {
+    // wpgs 动态修正：Append 表示之前的结果已是最终结果，Replace 表示替换 sn 在 [replaceBegin, replaceEnd] 内的结果
+    enum class Progressive { None, Append, Replace };
+
+    int sn = 0;
+    bool isLast = false;
+    Progressive progressive = Progressive::None;
+    int replaceBegin = 0;
+    int replaceEnd = 0;
+
+    QByteArray text;
+    QVector<RecognitionWord> words;
+
+    QByteArrayView wordText(qsizetype index) const
+    {
+        const RecognitionWord& word = words.at(index);
+        return QByteArrayView(text.constData() + word.textOffset, word.textLength);
+    }
+
+    // 解析 data.result 对象；每个 ws 取第一个候选词。
+    // 标点等 bg 为 0 的词没有时间，取前一个词的结束时间，片段开头的用 previousEndMs。
+    // 结果级的 ed 是保留字段（实际为 0），最后一个词结束于收到结果时已发送的音频时长 audioEndMs
+    static RecognitionSegment fromJson(const QJsonObject& result, qint32 previousEndMs = 0, qint32 audioEndMs = 0);
+};
+
+Q_DECLARE_METATYPE(RecognitionSegment)
+
+#endif // RECOGNITIONRESULT_H
@@ -2,6 +2,7 @@
 #include <QUrlQuery>
 #include <QJsonArray>
 #include <QDebug>
+#include <algorithm>
 
 #if QT_CONFIG(permissions)
 #include <QCoreApplication>
@@ -17,20 +18,85 @@ QByteArray hmacSha256(const QByteArray& key, const QByteArray& message) {
     return code.result();
 }
 
-SpeechClient::SpeechClient(QObject *parent)
+SpeechClient::SpeechClient(QObject *parent, bool ownsAudioInput)
     : QObject(parent)
-    , m_networkManager(nullptr)
-    , m_isRecording(false)
+    , m_tlsSessionCache(new TlsSessionCache(this))
+    , m_hotwordFilter(new HotwordFilter(this))
+    , m_hotwordStream(m_hotwordFilter)
     , m_audioSource(nullptr)
     , m_audioBuffer(nullptr)
+    , m_isRecording(false)
+    , m_isConnecting(false)
+    , m_ownsAudioInput(ownsAudioInput)
+    , m_networkManager(nullptr)
     , m_keepAliveTimer(nullptr)
+    , m_dnsRefreshTimer(nullptr)
+    , m_audioDevice(nullptr)
+    , m_sentBytes(0)
+    , m_capturedBytes(0)
+    , m_lastWordEndMs(0)
+    , m_serverUrl(BASE_URL)
 {
     initWebSocket();
-    init();
+    if (m_ownsAudioInput) {
+        init();
+    }
 
     m_keepAliveTimer = new QTimer(this);
     connect(m_keepAliveTimer, &QTimer::timeout, this, &SpeechClient::sendKeepAlive);
     m_keepAliveTimer->start(15000);
+
+    // Qt 的主机缓存 60 秒后过期，定期重新解析，任何时候开始识别都不必等待 DNS
+    m_dnsRefreshTimer = new QTimer(this);
+    connect(m_dnsRefreshTimer, &QTimer::timeout, this, &SpeechClient::warmUpHost);
+    m_dnsRefreshTimer->start(DNS_REFRESH_MS);
+
+    warmUpHost();
+}
+
+void SpeechClient::setTlsSessionStorePath(const QString& path)
+{
+    m_tlsSessionCache->setStorePath(path);
+}
+
+void SpeechClient::setServerUrl(const QUrl& url)
+{
+    m_serverUrl = url;
+    warmUpHost();
+}
+
+void SpeechClient::warmUpHost()
+{
+    // 提前解析一次，预热 Qt 内部的主机缓存，首次连接不必等待 DNS
+    QHostInfo::lookupHost(m_serverUrl.host(), this, [](const QHostInfo& info) {
+        if (info.error() != QHostInfo::NoError)
+            qDebug() << "DNS warm-up failed for" << info.hostName() << ":" << info.errorString();
+    });
+}
+
+QString SpeechClient::tlsPeer() const
+{
+    return QString("%1:%2").arg(m_serverUrl.host()).arg(m_serverUrl.port(443));
+}
+
+bool SpeechClient::loadHotwordDictionary(const QString& path)
+{
+    return m_hotwordFilter->load(path);
+}
+
+void SpeechClient::setTlsSessionCache(TlsSessionCache* cache)
+{
+    if (m_tlsSessionCache->parent() == this)
+        delete m_tlsSessionCache;
+    m_tlsSessionCache = cache;
+}
+
+void SpeechClient::setHotwordFilter(HotwordFilter* filter)
+{
+    if (m_hotwordFilter->parent() == this)
+        delete m_hotwordFilter;
+    m_hotwordFilter = filter;
+    m_hotwordStream.setFilter(filter);
 }
 
 void SpeechClient::sendKeepAlive()
@@ -86,11 +152,11 @@ void SpeechClient::init()
 
 void SpeechClient::initWebSocket()
 {
-    QSslConfiguration sslConfig = QSslConfiguration::defaultConfiguration();
-    sslConfig.setPeerVerifyMode(QSslSocket::VerifyNone);
-    sslConfig.setProtocol(QSsl::TlsV1_2OrLater);
+    m_sslConfig = QSslConfiguration::defaultConfiguration();
+    m_sslConfig.setPeerVerifyMode(QSslSocket::VerifyNone);
+    m_sslConfig.setProtocol(QSsl::TlsV1_2OrLater);
 
-    m_webSocket.setSslConfiguration(sslConfig);
+    m_webSocket.setSslConfiguration(m_sslConfig);
 
     connect(&m_webSocket, &QWebSocket::connected, this, &SpeechClient::onConnected);
     connect(&m_webSocket, &QWebSocket::disconnected, this, &SpeechClient::onDisconnected);
@@ -144,17 +210,18 @@ void SpeechClient::initAudioInput()
 
 QString SpeechClient::generateAuthUrl()
 {
-    QString baseUrl = "wss://iat-api.xfyun.cn/v2/iat";
-    QUrl url(baseUrl);
+    QUrl url(m_serverUrl);
+    const QString host = m_serverUrl.host();
 
     QDateTime now = QDateTime::currentDateTimeUtc();
     QString date = now.toString("ddd, dd MMM yyyy HH:mm:ss") + " GMT";
 
     QString signatureOrigin = QString("host: %1\n"
                                       "date: %2\n"
-                                      "GET /v2/iat HTTP/1.1")
-                                  .arg(HOST)
-                                  .arg(date);
+                                      "GET %3 HTTP/1.1")
+                                  .arg(host)
+                                  .arg(date)
+                                  .arg(m_serverUrl.path());
 
     qDebug() << "Signature Origin String:" << signatureOrigin;
 
@@ -177,7 +244,7 @@ QString SpeechClient::generateAuthUrl()
     QUrlQuery query;
     query.addQueryItem("authorization", authorization);
     query.addQueryItem("date", date);
-    query.addQueryItem("host", HOST);
+    query.addQueryItem("host", host);
 
     url.setQuery(query);
 
@@ -191,12 +258,14 @@ QString SpeechClient::generateAuthUrl()
 
 void SpeechClient::startRecognition()
 {
-    if (!m_audioSource || m_audioSource->error() != QAudio::NoError) {
+    if (m_ownsAudioInput && (!m_audioSource || m_audioSource->error() != QAudio::NoError)) {
         qDebug() << "Audio source error:" << (m_audioSource ? m_audioSource->error() : QAudio::OpenError);
         emit connectionError("音频设备错误");
         return;
     }
 
+    m_isConnecting = true;
+
     QDateTime now = QDateTime::currentDateTimeUtc();
     QString date = now.toString("ddd, dd MMM yyyy HH:mm:ss") + " GMT";
 
@@ -215,11 +284,11 @@ void SpeechClient::startRecognition()
 
     QNetworkRequest request(httpUrl);
 
-    QSslConfiguration sslConfig = QSslConfiguration::defaultConfiguration();
-    sslConfig.setPeerVerifyMode(QSslSocket::VerifyNone);
+    QSslConfiguration sslConfig = m_sslConfig;
+    m_tlsSessionCache->takeSession(tlsPeer(), sslConfig);
     request.setSslConfiguration(sslConfig);
 
-    request.setRawHeader("Host", HOST.toUtf8());
+    request.setRawHeader("Host", m_serverUrl.host().toUtf8());
     request.setRawHeader("Date", date.toUtf8());
     request.setRawHeader("User-Agent", "Mozilla/5.0");
     request.setRawHeader("Upgrade", "websocket");
@@ -243,18 +312,39 @@ void SpeechClient::startRecognition()
         QByteArray responseData = reply->readAll();
         qDebug() << "Response Body:" << QString::fromUtf8(responseData);
 
+        m_tlsSessionCache->storeSession(tlsPeer(), reply->sslConfiguration());
+
         if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 101) {
-            m_webSocket.open(wsUrl);
+            openWebSocket(wsUrl);
         } else {
             QString errorStr = QString("Handshake failed with status code: %1").arg(
                 reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt());
             qDebug() << errorStr;
+            m_isConnecting = false;
             emit connectionError(errorStr);
         }
         reply->deleteLater();
     });
 }
 
+void SpeechClient::openWebSocket(const QUrl& url)
+{
+    QSslConfiguration sslConfig = m_sslConfig;
+    const bool ticketOffered = m_tlsSessionCache->takeSession(tlsPeer(), sslConfig);
+    m_webSocket.setSslConfiguration(sslConfig);
+    m_webSocket.open(url);
+
+    // QWebSocket::sslConfiguration() 只返回设置进去的配置，票据要从它内部的 QSslSocket 取。
+    // 重连时旧 socket 只是 deleteLater，仍是子对象，要取 open() 新建的那个（已开始连接）
+    const QList<QSslSocket*> sockets = m_webSocket.findChildren<QSslSocket*>(Qt::FindDirectChildrenOnly);
+    for (auto it = sockets.crbegin(); it != sockets.crend(); ++it) {
+        if ((*it)->state() != QAbstractSocket::UnconnectedState) {
+            m_tlsSessionCache->watchSocket(tlsPeer(), *it, ticketOffered);
+            break;
+        }
+    }
+}
+
 void SpeechClient::stopRecognition()
 {
     if (!m_isRecording) {
@@ -280,7 +370,7 @@ void SpeechClient::stopRecognition()
         QString frameStr = QJsonDocument(frame).toJson(QJsonDocument::Compact);
         m_webSocket.sendTextMessage(frameStr);
 
-        QTimer::singleShot(500, [this](){
+        QTimer::singleShot(500, this, [this](){
             m_webSocket.close();
         });
     }
@@ -318,10 +408,37 @@ void SpeechClient::onConnected()
     qDebug() << "Sending start frame:" << startFrameStr;
     m_webSocket.sendTextMessage(startFrameStr);
 
+    m_hotwordStream.reset();
+    m_timeline.clear();
+    m_sentBytes = 0;
+    m_capturedBytes = 0;
+    m_lastWordEndMs = 0;
+    m_isConnecting = false;
     m_isRecording = true;
-    m_audioDevice = m_audioSource->start();
-    connect(m_audioDevice, &QIODevice::readyRead, this, &SpeechClient::onAudioDataReady, Qt::UniqueConnection);
 
+    for (const PendingFrame& frame : std::as_const(m_pendingAudio))
+        sendAudioFrame(frame.pcm, frame.timestamp);
+    m_pendingAudio.clear();
+
+    if (m_ownsAudioInput) {
+        m_audioDevice = m_audioSource->start();
+        connect(m_audioDevice, &QIODevice::readyRead, this, &SpeechClient::onAudioDataReady, Qt::UniqueConnection);
+    }
+}
+
+void SpeechClient::feedAudio(const QByteArray& pcm, qint64 timestamp)
+{
+    if (m_isRecording && m_webSocket.state() == QAbstractSocket::ConnectedState) {
+        sendAudioFrame(pcm, timestamp);
+        return;
+    }
+
+    // 未连上时先缓存；时间戳倒退说明采集已重新开始，之前的缓存作废
+    while (!m_pendingAudio.isEmpty()
+           && (m_pendingAudio.first().timestamp > timestamp
+               || m_pendingAudio.first().timestamp < timestamp - PENDING_AUDIO_MS))
+        m_pendingAudio.removeFirst();
+    m_pendingAudio.append({ timestamp, pcm });
 }
 
 void SpeechClient::onAudioDataReady()
@@ -338,6 +455,10 @@ void SpeechClient::onAudioDataReady()
         return;
     }
 
+    // 被静音检测丢弃的音频也计入采集时间
+    const qint64 captureMs = m_capturedBytes / BYTES_PER_MS;
+    m_capturedBytes += data.size();
+
     const qint16* samples = reinterpret_cast<const qint16*>(data.constData());
     int sampleCount = data.size() / sizeof(qint16);
     qDebug() << "Sample count:" << sampleCount;
@@ -367,6 +488,27 @@ void SpeechClient::onAudioDataReady()
         return;
     }
 
+    sendAudioFrame(data, captureMs);
+}
+
+qint32 SpeechClient::toCaptureMs(qint32 sentMs) const
+{
+    const auto next = std::upper_bound(m_timeline.cbegin(), m_timeline.cend(), qint64(sentMs),
+                                       [](qint64 ms, const TimelinePoint& point) { return ms < point.sentMs; });
+    if (next == m_timeline.cbegin())
+        return sentMs;
+    const TimelinePoint& point = *(next - 1);
+    return qint32(point.captureMs + (sentMs - point.sentMs));
+}
+
+void SpeechClient::sendAudioFrame(const QByteArray& data, qint64 captureMs)
+{
+    const qint64 sentMs = m_sentBytes / BYTES_PER_MS;
+    if (m_timeline.isEmpty()
+        || captureMs - m_timeline.last().captureMs != sentMs - m_timeline.last().sentMs)
+        m_timeline.append({ sentMs, captureMs });
+    m_sentBytes += data.size();
+
     QJsonObject frame;
     QJsonObject dataObj;
     dataObj["status"] = 1;
@@ -406,29 +548,7 @@ void SpeechClient::onTextMessageReceived(const QString& message)
         return;
     }
 
-    QJsonObject data = obj["data"].toObject();
-    if (data.isEmpty()) {
-        return;
-    }
-
-    QJsonObject result = data["result"].toObject();
-    if (result.isEmpty()) {
-        return;
-    }
-
-    QJsonArray ws = result["ws"].toArray();
-    QString text;
-    for (const QJsonValue& w : ws) {
-        QJsonArray cw = w["cw"].toArray();
-        for (const QJsonValue& c : cw) {
-            text += c["w"].toString();
-        }
-    }
-
-    if (!text.isEmpty()) {
-        qDebug() << "Recognition result:" << text;
-        emit recognitionResult(text);
-    }
+    handleRecognitionResult(obj);
 }
 
 void SpeechClient::handleRecognitionResult(const QJsonObject& result)
@@ -443,18 +563,29 @@ void SpeechClient::handleRecognitionResult(const QJsonObject& result)
         return;
     }
 
-    QJsonArray ws = resultObj["ws"].toArray();
-    QString text;
-    for (const QJsonValue& w : ws) {
-        QJsonArray cw = w["cw"].toArray();
-        for (const QJsonValue& c : cw) {
-            text += c["w"].toString();
-        }
+    RecognitionSegment segment = RecognitionSegment::fromJson(resultObj, m_lastWordEndMs,
+                                                               qint32(m_sentBytes / BYTES_PER_MS));
+    if (!segment.words.isEmpty())
+        m_lastWordEndMs = segment.words.last().endMs;
+    // 词尾落在不连续点上时属于前一段音频，按前一毫秒换算
+    for (RecognitionWord& word : segment.words) {
+        const qint32 beginMs = word.beginMs;
+        word.beginMs = toCaptureMs(beginMs);
+        word.endMs = word.endMs > beginMs ? toCaptureMs(word.endMs - 1) + 1 : word.beginMs;
     }
 
-    if (!text.isEmpty()) {
-        emit recognitionResult(text);
-    }
+    // 空片段也要并入，rpl 可能只是删掉之前的内容
+    const QVector<RecognitionSegment> filtered = m_hotwordStream.update(segment);
+    for (const RecognitionSegment& filteredSegment : filtered)
+        emit recognitionSegment(filteredSegment);
+
+    // 未开启 wpgs 时每条结果各自独立
+    const bool isFinal = segment.isLast || segment.progressive == RecognitionSegment::Progressive::None;
+    const QString text = m_hotwordStream.text();
+    qDebug() << "Recognition result:" << text << (isFinal ? "(final)" : "");
+    emit recognitionResult(text, isFinal);
+    if (isFinal)
+        m_hotwordStream.reset();
 }
 
 void SpeechClient::handleHandshakeResponse(QNetworkReply* reply)
@@ -474,9 +605,11 @@ void SpeechClient::handleHandshakeResponse(QNetworkReply* reply)
         qDebug() << header.first << ":" << header.second;
     }
 
+    m_tlsSessionCache->storeSession(tlsPeer(), reply->sslConfiguration());
+
     if (statusCode == 101) {
         QUrl wsUrl = reply->url();
-        m_webSocket.open(wsUrl);
+        openWebSocket(wsUrl);
     } else {
         QString errorStr = QString("Handshake failed with status code: %1").arg(statusCode);
         qDebug() << errorStr;
@@ -495,14 +628,17 @@ void SpeechClient::onError(QAbstractSocket::SocketError error)
     qDebug() << "URL:" << m_webSocket.requestUrl().toString();
     qDebug() << "State:" << m_webSocket.state();
 
+    m_isConnecting = false;
     emit connectionError(errorStr);
     stopRecognition();
 }
 
 void SpeechClient::onDisconnected()
 {
+    m_isConnecting = false;
     stopRecognition();
     emit statusChanged("已断开连接");
+    emit sessionClosed();
 }
 
 void SpeechClient::onBinaryMessageReceived(const QByteArray& message)
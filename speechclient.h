@@ -26,6 +26,14 @@
 #include <QUuid>
 
 #include <QCryptographicHash>
+#include <QHostInfo>
+#include <QSslConfiguration>
+#include <QSslSocket>
+
+#include "hotwordfilter.h"
+#include "hotwordstream.h"
+#include "recognitionresult.h"
+#include "tlssessioncache.h"
 
 #ifdef Q_OS_MAC
 #include <CommonCrypto/CommonHMAC.h>
@@ -36,16 +44,41 @@ class SpeechClient : public QObject
     Q_OBJECT
 
 public:
-    explicit SpeechClient(QObject *parent = nullptr);
+    // ownsAudioInput 为 false 时不打开麦克风，音频由 feedAudio() 提供
+    explicit SpeechClient(QObject *parent = nullptr, bool ownsAudioInput = true);
     ~SpeechClient();
 
     void startRecognition();
     void stopRecognition();
+    // 正在建连或已在识别
+    bool isActive() const { return m_isConnecting || m_isRecording; }
+
+    // 设置 TLS 会话票据的持久化文件，重启后可继续复用会话
+    void setTlsSessionStorePath(const QString& path);
+    // 替换服务地址，用于连接本地测试服务器（如 tools/tls_resumption_server.py）
+    void setServerUrl(const QUrl& url);
+    // 加载热词/屏蔽词典（HotwordDictionary 编译的二进制文件），文件更新后自动重载
+    bool loadHotwordDictionary(const QString& path);
+
+    // 多个会话共用同一个票据缓存/词典时注入，调用方负责其生命周期
+    void setTlsSessionCache(TlsSessionCache* cache);
+    void setHotwordFilter(HotwordFilter* filter);
+
+public slots:
+    // 外部采集的 16kHz 单声道 16bit PCM；连接建立前最多缓存 PENDING_AUDIO_MS，连上后补发。
+    // timestamp 为该段音频在采集时间轴上的毫秒数，识别结果的词时间按它换算
+    void feedAudio(const QByteArray& pcm, qint64 timestamp);
 
 signals:
-    void recognitionResult(const QString& text);
+    // 经热词处理的当前整句，wpgs 修正时整句重发；isFinal 为 true 表示本句结束（ls，或未开启 wpgs 时的每条结果）
+    void recognitionResult(const QString& text, bool isFinal);
+    // 带词级时间戳和 sn/ls/wpgs 信息的结构化结果，已经过热词处理，时间在采集时间轴上。
+    // 热词跨片段时之前的片段会以 Replace 重发，详见 HotwordStream
+    void recognitionSegment(const RecognitionSegment& segment);
     void connectionError(const QString& error);
     void statusChanged(const QString& status);
+    // WebSocket 已关闭（服务端结束会话、出错或主动停止）
+    void sessionClosed();
 
 private slots:
     void onConnected();
@@ -61,27 +94,63 @@ private:
     void initWebSocket();
     void initAudioInput();
     QString generateAuthUrl();
+    void openWebSocket(const QUrl& url);
+    void warmUpHost();
+    QString tlsPeer() const;
+    void sendAudioFrame(const QByteArray& data, qint64 captureMs);
+    qint32 toCaptureMs(qint32 sentMs) const;
     void handleRecognitionResult(const QJsonObject& result);
 
     QWebSocket m_webSocket;
+    QSslConfiguration m_sslConfig;
+    TlsSessionCache* m_tlsSessionCache;
+    HotwordFilter* m_hotwordFilter;
+    HotwordStream m_hotwordStream;
     QAudioSource* m_audioSource;
     QBuffer* m_audioBuffer;
     bool m_isRecording;
+    bool m_isConnecting;
+    bool m_ownsAudioInput;
 
     QNetworkAccessManager* m_networkManager;
     void handleHandshakeResponse(QNetworkReply* reply);
 
     QTimer* m_keepAliveTimer;
+    QTimer* m_dnsRefreshTimer;
 
     QIODevice* m_audioDevice;
 
+    // 服务端的时间只计入实际发送的音频，静音帧被跳过后需要换算回采集时间。
+    // 每当发送的音频在采集时间上不连续时记录一个对应点
+    struct TimelinePoint {
+        qint64 sentMs;
+        qint64 captureMs;
+    };
+    QVector<TimelinePoint> m_timeline;
+    qint64 m_sentBytes;
+    qint64 m_capturedBytes;
+    struct PendingFrame {
+        qint64 timestamp;
+        QByteArray pcm;
+    };
+    QList<PendingFrame> m_pendingAudio;
+
+    // 上一个有时间的词的结束时间（服务端时间），给片段开头的标点用
+    qint32 m_lastWordEndMs;
+    // 16kHz、单声道、16bit
+    static constexpr int BYTES_PER_MS = 16000 / 1000 * 2;
+    // 略短于 Qt 主机缓存的 60 秒有效期
+    static constexpr int DNS_REFRESH_MS = 50000;
+    // 覆盖预录音、建连和会话重连的间隔
+    static constexpr int PENDING_AUDIO_MS = 5000;
+
     // 讯飞 API 认证信息 - WebAPI 只需要 APIKey 和 APISecret
     const QString API_KEY = "xxx";
     const QString API_SECRET = "xxx";
 
     // WebSocket 连接参数
     const QString BASE_URL = "wss://iat-api.xfyun.cn/v2/iat";
-    const QString HOST = "iat-api.xfyun.cn";
+    QUrl m_serverUrl;
 
 };
 
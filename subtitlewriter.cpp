@@ -0,0 +1,143 @@
+#include "subtitlewriter.h"
+
+namespace {
+int utf8CharCount(QByteArrayView text)
+{
+    int count = 0;
+    for (char c : text) {
+        if ((uchar(c) & 0xC0) != 0x80)
+            ++count;
+    }
+    return count;
+}
+
+bool endsSentence(QByteArrayView text)
+{
+    static const QByteArrayView terminators[] = { "。", "！", "？", ".", "!", "?" };
+    for (QByteArrayView terminator : terminators) {
+        if (text.endsWith(terminator))
+            return true;
+    }
+    return false;
+}
+}
+
+SubtitleWriter::SubtitleWriter(QIODevice* device, Format format)
+    : m_device(device)
+    , m_format(format)
+    , m_timeOffset(0)
+    , m_cueIndex(0)
+    , m_cueChars(0)
+    , m_cueBegin(0)
+    , m_cueEnd(0)
+    , m_heldBegin(0)
+    , m_heldEnd(0)
+{
+}
+
+void SubtitleWriter::addSegment(const RecognitionSegment& segment)
+{
+    switch (segment.progressive) {
+    case RecognitionSegment::Progressive::Replace:
+        m_pending.erase(m_pending.lowerBound(segment.replaceBegin),
+                        m_pending.upperBound(segment.replaceEnd));
+        break;
+    case RecognitionSegment::Progressive::Append:
+        // apd 表示之前的结果都不会再被修正，词可以进入字幕条目，但条目不必在此结束
+        flushPending();
+        break;
+    case RecognitionSegment::Progressive::None:
+        break;
+    }
+
+    m_pending.insert(segment.sn, segment);
+
+    // 一句结束或未开启 wpgs（每条结果本身就是最终结果）时写出当前条目
+    if (segment.isLast || segment.progressive == RecognitionSegment::Progressive::None) {
+        flushPending();
+        writeCue();
+    }
+}
+
+void SubtitleWriter::finish()
+{
+    flushPending();
+    writeCue();
+    writeHeldCue(m_heldEnd);
+}
+
+void SubtitleWriter::flushPending()
+{
+    for (const RecognitionSegment& segment : std::as_const(m_pending)) {
+        for (qsizetype i = 0; i < segment.words.size(); ++i)
+            appendWord(segment, i);
+    }
+    m_pending.clear();
+}
+
+void SubtitleWriter::appendWord(const RecognitionSegment& segment, qsizetype index)
+{
+    const RecognitionWord& word = segment.words.at(index);
+    const QByteArrayView text = segment.wordText(index);
+    const qint64 begin = m_timeOffset + word.beginMs;
+    const qint64 end = m_timeOffset + word.endMs;
+
+    if (!m_cueText.isEmpty() && end - m_cueBegin > MAX_CUE_MS)
+        writeCue();
+
+    if (m_cueText.isEmpty())
+        m_cueBegin = begin;
+    m_cueText.append(text);
+    m_cueChars += utf8CharCount(text);
+    m_cueEnd = qMax(m_cueEnd, end);
+
+    if (m_cueChars >= MAX_CUE_CHARS || endsSentence(text))
+        writeCue();
+}
+
+void SubtitleWriter::writeCue()
+{
+    if (m_cueText.isEmpty())
+        return;
+
+    writeHeldCue(qMin(m_heldEnd, m_cueBegin));
+
+    m_heldText = m_cueText;
+    m_heldBegin = m_cueBegin;
+    m_heldEnd = qMax(m_cueEnd, m_cueBegin + MIN_CUE_MS);
+
+    m_cueText.clear();
+    m_cueChars = 0;
+    m_cueEnd = 0;
+}
+
+void SubtitleWriter::writeHeldCue(qint64 end)
+{
+    if (m_heldText.isEmpty())
+        return;
+
+    if (m_cueIndex == 0 && m_format == Format::WebVtt)
+        m_device->write("WEBVTT\n\n");
+    ++m_cueIndex;
+
+    QByteArray cue;
+    if (m_format == Format::Srt)
+        cue += QByteArray::number(m_cueIndex) + '\n';
+    cue += formatTime(m_heldBegin) + " --> " + formatTime(qMax(end, m_heldBegin)) + '\n';
+    cue += m_heldText + "\n\n";
+    m_device->write(cue);
+
+    m_heldText.clear();
+}
+
+QByteArray SubtitleWriter::formatTime(qint64 ms) const
+{
+    const char separator = m_format == Format::Srt ? ',' : '.';
+    return QString("%1:%2:%3%4%5")
+        .arg(ms / 3600000, 2, 10, QChar('0'))
+        .arg(ms / 60000 % 60, 2, 10, QChar('0'))
+        .arg(ms / 1000 % 60, 2, 10, QChar('0'))
+        .arg(separator)
+        .arg(ms % 1000, 3, 10, QChar('0'))
+        .toLatin1();
+}
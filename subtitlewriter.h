@@ -0,0 +1,55 @@
+#ifndef SUBTITLEWRITER_H
+#define SUBTITLEWRITER_H
+
+#include <QIODevice>
+#include <QMap>
+
+#include "recognitionresult.h"
+
+// 流式字幕输出：按 wpgs 规则维护未定稿的结果，一旦确认为最终结果就切分成
+// 字幕条目写出，无需等整段识别结束。输入应为 SpeechClient::recognitionSegment
+// 发出的结果，热词已经替换过。每个条目等下一条开始后才写出，以便把结束时间
+// 截到下一条的开始，避免最短显示时长造成重叠；最后一条由 finish() 写出。
+class SubtitleWriter
+{
+public:
+    enum class Format { Srt, WebVtt };
+
+    SubtitleWriter(QIODevice* device, Format format);
+
+    // 多次会话写入同一文件时，用于把会话内的时间平移到全局时间轴
+    void setTimeOffset(qint64 ms) { m_timeOffset = ms; }
+
+    void addSegment(const RecognitionSegment& segment);
+    // 写出所有未定稿的结果和最后一条字幕，输出结束时调用
+    void finish();
+
+private:
+    void flushPending();
+    void appendWord(const RecognitionSegment& segment, qsizetype index);
+    void writeCue();
+    void writeHeldCue(qint64 end);
+    QByteArray formatTime(qint64 ms) const;
+
+    QIODevice* m_device;
+    Format m_format;
+    qint64 m_timeOffset;
+    int m_cueIndex;
+
+    QMap<int, RecognitionSegment> m_pending;
+
+    QByteArray m_cueText;
+    int m_cueChars;
+    qint64 m_cueBegin;
+    qint64 m_cueEnd;
+
+    QByteArray m_heldText;
+    qint64 m_heldBegin;
+    qint64 m_heldEnd;
+
+    static constexpr int MAX_CUE_CHARS = 20;
+    static constexpr int MAX_CUE_MS = 5000;
+    static constexpr int MIN_CUE_MS = 500;
+};
+
+#endif // SUBTITLEWRITER_H
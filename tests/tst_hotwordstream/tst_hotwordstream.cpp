@@ -0,0 +1,284 @@
+#include <QtTest>
+#include <QMap>
+#include <QRandomGenerator>
+#include <QSet>
+#include <QTemporaryDir>
+#include <cstring>
+
+#include "hotworddictionary.h"
+#include "hotwordfilter.h"
+#include "hotwordstream.h"
+
+namespace {
+// 与 HotwordDictionary 映像布局一致，用来构造损坏的映像
+const int HEADER_SIZE = 6 * sizeof(quint32);
+const int CHARMAP_BYTES = 65536 * sizeof(quint16);
+
+quint32 stateCountOf(const QByteArray& image)
+{
+    quint32 count;
+    std::memcpy(&count, image.constData() + 2 * sizeof(quint32), sizeof(count));
+    return count;
+}
+
+qint32* stateArray(QByteArray& image, int index)
+{
+    const qsizetype offset = HEADER_SIZE + CHARMAP_BYTES + qsizetype(index) * stateCountOf(image) * sizeof(qint32);
+    return reinterpret_cast<qint32*>(image.data() + offset);
+}
+
+enum StateArray { Base, Check, Fail, Output, Depth };
+
+// 逐位置取最长词条，作为匹配结果的参照
+QString referenceProcess(const HotwordDictionary::Entries& entries, const QString& text)
+{
+    QHash<QString, QString> replacements;
+    for (const auto& entry : entries)
+        replacements.insert(entry.first, entry.second);
+
+    QString result;
+    for (qsizetype i = 0; i < text.size();) {
+        QString best;
+        for (auto it = replacements.cbegin(); it != replacements.cend(); ++it) {
+            if (it.key().size() > best.size() && QStringView(text).mid(i).startsWith(it.key()))
+                best = it.key();
+        }
+        if (best.isEmpty()) {
+            result.append(text.at(i++));
+        } else {
+            result.append(replacements.value(best));
+            i += best.size();
+        }
+    }
+    return result;
+}
+
+QString randomString(QRandomGenerator& random, const QString& alphabet, int minLength, int maxLength)
+{
+    QString text;
+    const int length = random.bounded(minLength, maxLength + 1);
+    for (int i = 0; i < length; ++i)
+        text.append(alphabet.at(random.bounded(int(alphabet.size()))));
+    return text;
+}
+
+HotwordDictionary::Entries randomEntries(QRandomGenerator& random, const QString& alphabet)
+{
+    static const QString replacements[] = { "", "X", "YZ", "甲乙" };
+    HotwordDictionary::Entries entries;
+    const int count = random.bounded(1, 9);
+    for (int i = 0; i < count; ++i)
+        entries.append({ randomString(random, alphabet, 1, 4), replacements[random.bounded(4)] });
+    return entries;
+}
+
+RecognitionSegment makeSegment(int sn, RecognitionSegment::Progressive progressive,
+                               int replaceBegin, int replaceEnd, const QStringList& words)
+{
+    RecognitionSegment segment;
+    segment.sn = sn;
+    segment.progressive = progressive;
+    segment.replaceBegin = replaceBegin;
+    segment.replaceEnd = replaceEnd;
+    for (qsizetype i = 0; i < words.size(); ++i) {
+        const QByteArray utf8 = words.at(i).toUtf8();
+        RecognitionWord word;
+        word.textOffset = quint32(segment.text.size());
+        word.textLength = quint32(utf8.size());
+        word.beginMs = qint32(sn * 1000 + i * 100);
+        word.endMs = word.beginMs + 100;
+        segment.text.append(utf8);
+        segment.words.append(word);
+    }
+    return segment;
+}
+}
+
+class TestHotwordStream : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void processMatchesReference();
+    void rejectsDamagedImages();
+    void mergesHotwordAcrossSegments();
+    void streamMatchesFullRescan_data();
+    void streamMatchesFullRescan();
+
+private:
+    bool loadFilter(HotwordFilter& filter, const HotwordDictionary::Entries& entries);
+
+    QTemporaryDir m_dir;
+    int m_dictionaryIndex = 0;
+};
+
+bool TestHotwordStream::loadFilter(HotwordFilter& filter, const HotwordDictionary::Entries& entries)
+{
+    const QString path = m_dir.filePath(QString("dictionary%1.bin").arg(m_dictionaryIndex++));
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(HotwordDictionary::compile(entries));
+    file.close();
+    return filter.load(path);
+}
+
+void TestHotwordStream::processMatchesReference()
+{
+    QRandomGenerator random(1);
+    for (int round = 0; round < 2000; ++round) {
+        const HotwordDictionary::Entries entries = randomEntries(random, "abcd");
+        const QString text = randomString(random, "abcdx", 0, 30);
+        const auto dictionary = HotwordDictionary::fromImage(HotwordDictionary::compile(entries));
+        QVERIFY(dictionary);
+        QCOMPARE(dictionary->process(text), referenceProcess(entries, text));
+    }
+}
+
+void TestHotwordStream::rejectsDamagedImages()
+{
+    const QByteArray image = HotwordDictionary::compile({ { "ab", "X" }, { "b", "Y" }, { "abc", "Z" } });
+    QVERIFY(HotwordDictionary::fromImage(image));
+
+    // 取一个非根的已用状态
+    QByteArray probe = image;
+    qint32 state = -1;
+    for (quint32 s = 1; s < stateCountOf(probe); ++s) {
+        if (stateArray(probe, Check)[s] != -1 && stateArray(probe, Depth)[s] == 1) {
+            state = qint32(s);
+            break;
+        }
+    }
+    QVERIFY(state > 0);
+
+    QByteArray negativeRootBase = image;
+    stateArray(negativeRootBase, Base)[0] = -100000;
+    QVERIFY(!HotwordDictionary::fromImage(negativeRootBase));
+
+    QByteArray failCycle = image;
+    stateArray(failCycle, Fail)[state] = state;
+    QVERIFY(!HotwordDictionary::fromImage(failCycle));
+
+    QByteArray wrongDepth = image;
+    stateArray(wrongDepth, Depth)[state] = 5;
+    QVERIFY(!HotwordDictionary::fromImage(wrongDepth));
+
+    // 词条 2 为 "abc"，不可能在深度 1 的状态结束
+    QByteArray longOutput = image;
+    stateArray(longOutput, Output)[state] = 2;
+    QVERIFY(!HotwordDictionary::fromImage(longOutput));
+}
+
+void TestHotwordStream::mergesHotwordAcrossSegments()
+{
+    HotwordFilter filter;
+    QVERIFY(loadFilter(filter, { { "北京", "BJ" } }));
+    HotwordStream stream(&filter);
+
+    using Progressive = RecognitionSegment::Progressive;
+    QVector<RecognitionSegment> segments = stream.update(makeSegment(1, Progressive::Append, 0, 0, { "去", "北" }));
+    QCOMPARE(segments.size(), 1);
+    QCOMPARE(stream.text(), QString("去北"));
+
+    // 上一片段停在热词前缀上，apd 不能原样转发，且第一个片段要带着合并后的词重发
+    segments = stream.update(makeSegment(2, Progressive::Append, 0, 0, { "京", "了" }));
+    QCOMPARE(stream.text(), QString("去BJ了"));
+    QCOMPARE(segments.size(), 2);
+    QCOMPARE(segments.at(0).sn, 1);
+    QCOMPARE(segments.at(0).progressive, Progressive::Replace);
+    QCOMPARE(segments.at(0).text, QByteArray("去BJ"));
+    QCOMPARE(segments.at(0).words.size(), 2);
+    QCOMPARE(segments.at(0).words.at(1).beginMs, 1100);
+    QCOMPARE(segments.at(0).words.at(1).endMs, 2100);
+    QCOMPARE(segments.at(1).sn, 2);
+    QCOMPARE(segments.at(1).progressive, Progressive::Replace);
+    QCOMPARE(segments.at(1).text, QByteArray("了"));
+
+    // 上一片段结尾不在任何热词前缀上时 apd 原样转发
+    segments = stream.update(makeSegment(3, Progressive::Append, 0, 0, { "吧" }));
+    QCOMPARE(segments.size(), 1);
+    QCOMPARE(segments.at(0).progressive, Progressive::Append);
+}
+
+void TestHotwordStream::streamMatchesFullRescan_data()
+{
+    QTest::addColumn<QString>("alphabet");
+    QTest::newRow("ascii") << QString("abcd");
+    QTest::newRow("cjk") << QString("北京市人");
+}
+
+void TestHotwordStream::streamMatchesFullRescan()
+{
+    QFETCH(QString, alphabet);
+    using Progressive = RecognitionSegment::Progressive;
+
+    QRandomGenerator random(7);
+    for (int round = 0; round < 300; ++round) {
+        const HotwordDictionary::Entries entries = randomEntries(random, alphabet);
+        HotwordFilter filter;
+        QVERIFY(loadFilter(filter, entries));
+        const auto dictionary = filter.dictionary();
+        HotwordStream stream(&filter);
+
+        // 服务端视角的原始结果，以及按下游（如 SubtitleWriter）的规则重放输出得到的文本
+        QMap<int, QString> raw;
+        QMap<int, QByteArray> pending;
+        QByteArray flushed;
+        QSet<int> flushedSn;
+        int lastAppend = 0;
+
+        for (int sn = 1; sn <= 15; ++sn) {
+            QStringList words;
+            const int wordCount = random.bounded(4);
+            for (int i = 0; i < wordCount; ++i)
+                words.append(randomString(random, alphabet + "x", 1, 3));
+
+            RecognitionSegment segment;
+            if (!raw.isEmpty() && random.bounded(2) == 0) {
+                QList<int> candidates;
+                for (int key : raw.keys()) {
+                    if (key >= lastAppend)
+                        candidates.append(key);
+                }
+                if (candidates.isEmpty())
+                    candidates.append(raw.lastKey());
+                const int begin = candidates.at(random.bounded(int(candidates.size())));
+                const int end = raw.lastKey();
+                segment = makeSegment(sn, Progressive::Replace, begin, end, words);
+                raw.erase(raw.lowerBound(begin), raw.upperBound(end));
+            } else {
+                segment = makeSegment(sn, Progressive::Append, 0, 0, words);
+                lastAppend = sn;
+            }
+            raw.insert(sn, words.join(QString()));
+
+            const QVector<RecognitionSegment> output = stream.update(segment);
+            for (const RecognitionSegment& result : output) {
+                QVERIFY2(!flushedSn.contains(result.sn), "re-emitted a segment after it was finalized");
+                if (result.progressive == Progressive::Replace)
+                    pending.erase(pending.lowerBound(result.replaceBegin), pending.upperBound(result.replaceEnd));
+                if (result.progressive == Progressive::Append) {
+                    for (auto it = pending.cbegin(); it != pending.cend(); ++it) {
+                        flushed.append(it.value());
+                        flushedSn.insert(it.key());
+                    }
+                    pending.clear();
+                }
+                pending.insert(result.sn, result.text);
+            }
+
+            QString whole;
+            for (const QString& text : std::as_const(raw))
+                whole.append(text);
+            QCOMPARE(stream.text(), dictionary->process(whole));
+
+            QByteArray replayed = flushed;
+            for (const QByteArray& text : std::as_const(pending))
+                replayed.append(text);
+            QCOMPARE(replayed, stream.text().toUtf8());
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(TestHotwordStream)
+#include "tst_hotwordstream.moc"
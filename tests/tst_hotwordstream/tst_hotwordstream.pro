@@ -0,0 +1,21 @@
+QT += testlib
+QT -= gui
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+TARGET = tst_hotwordstream
+TEMPLATE = app
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    tst_hotwordstream.cpp \
+    ../../hotworddictionary.cpp \
+    ../../hotwordfilter.cpp \
+    ../../hotwordstream.cpp \
+    ../../recognitionresult.cpp
+
+HEADERS += \
+    ../../hotworddictionary.h \
+    ../../hotwordfilter.h \
+    ../../hotwordstream.h \
+    ../../recognitionresult.h
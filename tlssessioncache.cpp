@@ -0,0 +1,172 @@
+#include "tlssessioncache.h"
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDebug>
+
+namespace {
+const quint32 STORE_MAGIC = 0x544c5353; // "TLSS"
+const quint16 STORE_VERSION = 2;
+}
+
+TlsSessionCache::TlsSessionCache(QObject *parent)
+    : QObject(parent)
+{
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(SAVE_DELAY_MS);
+    connect(&m_saveTimer, &QTimer::timeout, this, &TlsSessionCache::save);
+}
+
+TlsSessionCache::~TlsSessionCache()
+{
+    if (m_saveTimer.isActive())
+        save();
+}
+
+void TlsSessionCache::scheduleSave()
+{
+    if (!m_storePath.isEmpty() && !m_saveTimer.isActive())
+        m_saveTimer.start();
+}
+
+void TlsSessionCache::setStorePath(const QString& path)
+{
+    m_storePath = path;
+    if (!m_storePath.isEmpty()) {
+        load();
+    }
+}
+
+bool TlsSessionCache::takeSession(const QString& peer, QSslConfiguration& config)
+{
+    // 会话持久化默认关闭，不打开则拿不到票据
+    config.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+    config.setSslOption(QSsl::SslOptionDisableSessionSharing, false);
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    QList<Session>& sessions = m_sessions[peer];
+    while (!sessions.isEmpty()) {
+        const Session session = sessions.takeLast();
+        if (session.expiry <= now)
+            continue;
+
+        config.setSessionTicket(session.ticket);
+        scheduleSave();
+        qDebug() << "Offering TLS session ticket to" << peer << ", expires at" << session.expiry.toString(Qt::ISODate);
+        return true;
+    }
+
+    qDebug() << "No TLS session ticket for" << peer << ", full handshake";
+    return false;
+}
+
+void TlsSessionCache::storeSession(const QString& peer, const QSslConfiguration& config)
+{
+    const QByteArray ticket = config.sessionTicket();
+    if (ticket.isEmpty()) {
+        return;
+    }
+
+    int lifetime = config.sessionTicketLifeTimeHint();
+    if (lifetime <= 0) {
+        lifetime = DEFAULT_TICKET_LIFETIME;
+    }
+
+    QList<Session>& sessions = m_sessions[peer];
+    for (const Session& session : std::as_const(sessions)) {
+        if (session.ticket == ticket)
+            return;
+    }
+
+    Session session;
+    session.ticket = ticket;
+    session.expiry = QDateTime::currentDateTimeUtc().addSecs(lifetime);
+    sessions.append(session);
+    while (sessions.size() > MAX_TICKETS_PER_PEER)
+        sessions.removeFirst();
+
+    qDebug() << "Stored TLS session ticket for" << peer << ", lifetime" << lifetime << "s";
+    scheduleSave();
+}
+
+void TlsSessionCache::watchSocket(const QString& peer, QSslSocket* socket, bool ticketOffered)
+{
+    // Qt 不公开服务端是否接受了票据，实际是否恢复会话需由服务端确认
+    // （见 tools/tls_resumption_server.py），这里只记录协商结果
+    connect(socket, &QSslSocket::encrypted, this, [this, peer, socket, ticketOffered]() {
+        qDebug() << "TLS handshake with" << peer << "done:" << socket->sessionProtocol()
+                 << (ticketOffered ? "(ticket offered)" : "(no ticket offered)");
+        storeSession(peer, socket->sslConfiguration());
+    });
+    connect(socket, &QSslSocket::newSessionTicketReceived, this, [this, peer, socket]() {
+        storeSession(peer, socket->sslConfiguration());
+    });
+}
+
+void TlsSessionCache::load()
+{
+    QFile file(m_storePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream in(&file);
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != STORE_MAGIC || version != STORE_VERSION) {
+        qDebug() << "Ignoring TLS session store with unknown format:" << m_storePath;
+        return;
+    }
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    int loaded = 0;
+    quint32 count = 0;
+    in >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString peer;
+        Session session;
+        in >> peer >> session.ticket >> session.expiry;
+        if (in.status() == QDataStream::Ok && session.expiry > now) {
+            m_sessions[peer].append(session);
+            ++loaded;
+        }
+    }
+
+    qDebug() << "Loaded" << loaded << "TLS session tickets from" << m_storePath;
+}
+
+void TlsSessionCache::save() const
+{
+    if (m_storePath.isEmpty()) {
+        return;
+    }
+
+    QDir().mkpath(QFileInfo(m_storePath).absolutePath());
+
+    // 票据可以恢复会话密钥，只允许当前用户读写
+    QSaveFile file(m_storePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Cannot write TLS session store:" << file.errorString();
+        return;
+    }
+    file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    QList<QPair<QString, Session>> valid;
+    for (auto it = m_sessions.constBegin(); it != m_sessions.constEnd(); ++it) {
+        for (const Session& session : it.value()) {
+            if (session.expiry > now)
+                valid.append({ it.key(), session });
+        }
+    }
+
+    QDataStream out(&file);
+    out << STORE_MAGIC << STORE_VERSION << quint32(valid.size());
+    for (const auto& entry : std::as_const(valid))
+        out << entry.first << entry.second.ticket << entry.second.expiry;
+
+    file.commit();
+}
@@ -0,0 +1,56 @@
+#ifndef TLSSESSIONCACHE_H
+#define TLSSESSIONCACHE_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QByteArray>
+#include <QDateTime>
+#include <QSslConfiguration>
+#include <QSslSocket>
+#include <QTimer>
+
+// 缓存 TLS 会话票据，减少每次识别建连的完整握手。票据按 "host:port" 分组保存，
+// 每张只使用一次（RFC 8446 不建议客户端重复使用 TLS 1.3 票据），
+// 可选择持久化到磁盘，进程重启后仍可恢复会话。
+class TlsSessionCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TlsSessionCache(QObject *parent = nullptr);
+    ~TlsSessionCache();
+
+    // 设置持久化文件路径并立即加载；传入空字符串则只保存在内存中
+    void setStorePath(const QString& path);
+
+    // 取出一张未过期的票据写入 config，取出后即从缓存中移除
+    bool takeSession(const QString& peer, QSslConfiguration& config);
+    // 从已完成握手的连接中取出会话票据
+    void storeSession(const QString& peer, const QSslConfiguration& config);
+    // TLS 1.3 票据在握手完成后才下发，需要监听 socket 收集
+    void watchSocket(const QString& peer, QSslSocket* socket, bool ticketOffered);
+
+private:
+    struct Session {
+        QByteArray ticket;
+        QDateTime expiry;
+    };
+
+    void load();
+    void save() const;
+    void scheduleSave();
+
+    QHash<QString, QList<Session>> m_sessions;
+    QString m_storePath;
+    // 一次建连会多次取出/存入票据，合并后在 GUI 线程空闲时写一次盘
+    QTimer m_saveTimer;
+
+    // 服务器未给出票据有效期时使用的默认值（秒）
+    static constexpr int DEFAULT_TICKET_LIFETIME = 300;
+    // 每个服务器最多保留的票据数
+    static constexpr int MAX_TICKETS_PER_PEER = 4;
+    static constexpr int SAVE_DELAY_MS = 2000;
+};
+
+#endif // TLSSESSIONCACHE_H
@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+"""Local TLS WebSocket server that reports full vs. resumed handshakes.
+
+Stands in for the iat endpoint so TLS session reuse in SpeechClient can be
+checked without the real service. Every accepted connection prints one line
+saying whether the client resumed a session, e.g.
+
+    [conn 3] TLSv1.3 resumed  GET /v2/iat -> 101
+
+Usage:
+    python3 tools/tls_resumption_server.py --port 8443
+    XFYUN_IAT_URL=wss://127.0.0.1:8443/v2/iat ./SpeechClient_xfyun
+
+A self-signed certificate is generated with the openssl CLI when --cert/--key
+are not given (the client runs with peer verification off).
+
+The server answers the HTTPS pre-flight and the WebSocket upgrade with 101,
+accepts audio frames and replies to the last frame (status 2) with an empty
+final result, so a whole recognition round trip can be exercised.
+"""
+
+import argparse
+import base64
+import hashlib
+import itertools
+import json
+import os
+import socket
+import ssl
+import struct
+import subprocess
+import tempfile
+import threading
+
+WS_GUID = b"258EAFA5-E914-47DA-95CA-C5AB0DC11B65"
+counter = itertools.count(1)
+stats_lock = threading.Lock()
+stats = {"full": 0, "resumed": 0}
+
+
+def make_self_signed(directory):
+    cert = os.path.join(directory, "cert.pem")
+    key = os.path.join(directory, "key.pem")
+    subprocess.run(
+        ["openssl", "req", "-x509", "-newkey", "rsa:2048", "-nodes", "-days", "1",
+         "-subj", "/CN=localhost", "-keyout", key, "-out", cert],
+        check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    return cert, key
+
+
+def read_request(conn):
+    data = b""
+    while b"\r\n\r\n" not in data:
+        chunk = conn.recv(4096)
+        if not chunk:
+            return None, {}
+        data += chunk
+    head = data.split(b"\r\n\r\n", 1)[0].decode("latin-1").split("\r\n")
+    headers = {}
+    for line in head[1:]:
+        name, _, value = line.partition(":")
+        headers[name.strip().lower()] = value.strip()
+    return head[0], headers
+
+
+def recv_exact(conn, size):
+    data = b""
+    while len(data) < size:
+        chunk = conn.recv(size - len(data))
+        if not chunk:
+            raise ConnectionError("peer closed")
+        data += chunk
+    return data
+
+
+def read_frame(conn):
+    first, second = recv_exact(conn, 2)
+    opcode = first & 0x0F
+    length = second & 0x7F
+    if length == 126:
+        length = struct.unpack("!H", recv_exact(conn, 2))[0]
+    elif length == 127:
+        length = struct.unpack("!Q", recv_exact(conn, 8))[0]
+    mask = recv_exact(conn, 4) if second & 0x80 else b"\0\0\0\0"
+    payload = bytearray(recv_exact(conn, length))
+    for i in range(length):
+        payload[i] ^= mask[i % 4]
+    return opcode, bytes(payload)
+
+
+def send_frame(conn, opcode, payload):
+    header = bytes([0x80 | opcode])
+    if len(payload) < 126:
+        header += bytes([len(payload)])
+    elif len(payload) < 65536:
+        header += bytes([126]) + struct.pack("!H", len(payload))
+    else:
+        header += bytes([127]) + struct.pack("!Q", len(payload))
+    conn.sendall(header + payload)
+
+
+def serve_websocket(conn):
+    while True:
+        opcode, payload = read_frame(conn)
+        if opcode == 0x8:
+            send_frame(conn, 0x8, payload[:2])
+            return
+        if opcode == 0x9:
+            send_frame(conn, 0xA, payload)
+            continue
+        if opcode != 0x1:
+            continue
+        frame = json.loads(payload)
+        if frame.get("data", {}).get("status") == 2:
+            result = {"code": 0, "message": "success", "sid": "local",
+                      "data": {"status": 2, "result": {"sn": 1, "ls": True, "bg": 0, "ed": 0, "ws": []}}}
+            send_frame(conn, 0x1, json.dumps(result).encode())
+
+
+def handle(conn, number):
+    try:
+        conn.do_handshake()
+        resumed = conn.session_reused
+        with stats_lock:
+            stats["resumed" if resumed else "full"] += 1
+        request_line, headers = read_request(conn)
+        if request_line is None:
+            print(f"[conn {number}] {conn.version()} {'resumed' if resumed else 'full'}  (no request)", flush=True)
+            return
+        key = headers.get("sec-websocket-key", "")
+        accept = base64.b64encode(hashlib.sha1(key.encode() + WS_GUID).digest()).decode()
+        conn.sendall(("HTTP/1.1 101 Switching Protocols\r\n"
+                      "Upgrade: websocket\r\nConnection: Upgrade\r\n"
+                      f"Sec-WebSocket-Accept: {accept}\r\n\r\n").encode())
+        print(f"[conn {number}] {conn.version()} {'resumed' if resumed else 'full'}  {request_line} -> 101", flush=True)
+        serve_websocket(conn)
+    except (ConnectionError, ssl.SSLError, OSError, ValueError) as error:
+        print(f"[conn {number}] closed: {error}", flush=True)
+    finally:
+        with stats_lock:
+            summary = dict(stats)
+        print(f"    totals: {summary['full']} full, {summary['resumed']} resumed", flush=True)
+        conn.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8443)
+    parser.add_argument("--cert")
+    parser.add_argument("--key")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as directory:
+        cert, key = (args.cert, args.key) if args.cert and args.key else make_self_signed(directory)
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        context.load_cert_chain(cert, key)
+
+        with socket.create_server((args.host, args.port)) as server:
+            print(f"Listening on wss://{args.host}:{args.port}/v2/iat", flush=True)
+            while True:
+                raw, _ = server.accept()
+                conn = context.wrap_socket(raw, server_side=True, do_handshake_on_connect=False)
+                threading.Thread(target=handle, args=(conn, next(counter)), daemon=True).start()
+
+
+if __name__ == "__main__":
+    main()